@@ -0,0 +1,120 @@
+/* BLE GATT example - adaptive advertising scheduler
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <string.h>    /* This is the standard C lib used for memset */
+#include "adv_sched.h" /* This is the adaptive advertising scheduler interface */
+
+/**
+ * @brief Open a fast advertising burst
+ *
+ * @param sched Scheduler state
+ * @param now_ms Current time
+ */
+static void Adv_Sched_Start_Burst(Adv_Sched *sched, uint32_t now_ms)
+{
+    sched->fast_until_ms = now_ms + ADV_SCHED_FAST_WINDOW_MS;
+    sched->fast_active = true;
+}
+
+/**
+ * @brief Initialise the scheduler at boot
+ *
+ * Boot counts as a disconnect for scheduling purposes: the device starts
+ * with a fast burst, but no reconnect latency is measured for it.
+ *
+ * @param sched Scheduler state
+ * @param now_ms Current time
+ */
+void Adv_Sched_Init(Adv_Sched *sched, uint32_t now_ms)
+{
+    memset(sched, 0, sizeof(*sched));
+    Adv_Sched_Start_Burst(sched, now_ms);
+}
+
+/**
+ * @brief Record a successful connection
+ *
+ * Ends the fast burst, since advertising that continues for further slots
+ * does not need to be aggressive, and measures the time since the last
+ * disconnect.
+ *
+ * @param sched Scheduler state
+ * @param now_ms Current time
+ * @return true if a reconnect latency was recorded
+ */
+bool Adv_Sched_On_Connect(Adv_Sched *sched, uint32_t now_ms)
+{
+    sched->fast_active = false;
+
+    if (!sched->awaiting_reconnect) /* First connection after boot, or a further slot */
+    {
+        return false;
+    }
+
+    uint32_t latency = now_ms - sched->disconnect_ms; /* Wrap safe difference */
+    Adv_Sched_Stats *stats = &sched->reconnect;
+
+    if (stats->count == 0 || latency < stats->min_ms)
+    {
+        stats->min_ms = latency;
+    }
+    if (latency > stats->max_ms)
+    {
+        stats->max_ms = latency;
+    }
+    stats->last_ms = latency;
+    stats->total_ms += latency;
+    stats->count++;
+    sched->awaiting_reconnect = false;
+    return true;
+}
+
+/**
+ * @brief Record a disconnect and open a fast burst
+ *
+ * @param sched Scheduler state
+ * @param now_ms Current time
+ */
+void Adv_Sched_On_Disconnect(Adv_Sched *sched, uint32_t now_ms)
+{
+    sched->disconnect_ms = now_ms;
+    sched->awaiting_reconnect = true;
+    Adv_Sched_Start_Burst(sched, now_ms);
+}
+
+/**
+ * @brief Choose the parameters of the next advertising run
+ *
+ * Inside a fast burst the run is limited to the rest of the burst, so the
+ * advertising complete event that follows brings the device back here to
+ * switch to the slow interval. Outside a burst the device advertises slowly
+ * until something else happens.
+ *
+ * @param sched Scheduler state
+ * @param now_ms Current time
+ * @param params Filled with the parameters to use
+ */
+void Adv_Sched_Next(Adv_Sched *sched, uint32_t now_ms, Adv_Sched_Params *params)
+{
+    int32_t remaining = (int32_t)(sched->fast_until_ms - now_ms); /* Wrap safe time left in the burst */
+
+    if (sched->fast_active && remaining > 0) /* Still inside the fast burst */
+    {
+        params->itvl_min_ms = ADV_SCHED_FAST_ITVL_MIN_MS;
+        params->itvl_max_ms = ADV_SCHED_FAST_ITVL_MAX_MS;
+        params->duration_ms = (uint32_t)remaining;
+        params->fast = true;
+        return;
+    }
+
+    sched->fast_active = false; /* Burst is over */
+    params->itvl_min_ms = ADV_SCHED_SLOW_ITVL_MIN_MS;
+    params->itvl_max_ms = ADV_SCHED_SLOW_ITVL_MAX_MS;
+    params->duration_ms = ADV_SCHED_FOREVER;
+    params->fast = false;
+}
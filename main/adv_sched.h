@@ -0,0 +1,67 @@
+/* BLE GATT example - adaptive advertising scheduler
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef ADV_SCHED_H
+#define ADV_SCHED_H
+
+#include <stdbool.h> /* This is the standard C lib used for the bool type */
+#include <stdint.h>  /* This is the standard C lib used for the fixed width integer types */
+
+#define ADV_SCHED_FAST_ITVL_MIN_MS 20   /* Fast advertising interval, lower bound */
+#define ADV_SCHED_FAST_ITVL_MAX_MS 30   /* Fast advertising interval, upper bound */
+#define ADV_SCHED_SLOW_ITVL_MIN_MS 1000 /* Power saving advertising interval, lower bound */
+#define ADV_SCHED_SLOW_ITVL_MAX_MS 1200 /* Power saving advertising interval, upper bound */
+#define ADV_SCHED_FAST_WINDOW_MS 30000  /* Length of the fast burst after boot or a disconnect */
+#define ADV_SCHED_FOREVER 0             /* Duration meaning advertise until stopped */
+
+/**
+ * @brief Advertising parameters chosen for the next advertising run
+ */
+typedef struct
+{
+    uint16_t itvl_min_ms; /* Minimum advertising interval */
+    uint16_t itvl_max_ms; /* Maximum advertising interval */
+    uint32_t duration_ms; /* How long to advertise before switching, or ADV_SCHED_FOREVER */
+    bool fast;            /* Parameters belong to the fast burst */
+} Adv_Sched_Params;
+
+/**
+ * @brief Time from a disconnect to the next connect
+ */
+typedef struct
+{
+    uint32_t count;   /* Reconnects measured */
+    uint32_t last_ms; /* Latency of the most recent reconnect */
+    uint32_t min_ms;  /* Shortest latency seen */
+    uint32_t max_ms;  /* Longest latency seen */
+    uint64_t total_ms; /* Sum of all latencies, for the average */
+} Adv_Sched_Stats;
+
+/**
+ * @brief Adaptive advertising state
+ *
+ * Advertises fast for ADV_SCHED_FAST_WINDOW_MS after boot and after every
+ * disconnect, so a returning central finds the device quickly, then backs
+ * off to the slow interval. Times are in milliseconds from any monotonic
+ * clock and may wrap.
+ */
+typedef struct
+{
+    uint32_t fast_until_ms;     /* End of the current fast burst */
+    bool fast_active;           /* A fast burst is in progress */
+    uint32_t disconnect_ms;     /* Time of the last disconnect */
+    bool awaiting_reconnect;    /* A disconnect has not been followed by a connect yet */
+    Adv_Sched_Stats reconnect;  /* Reconnect latency instrumentation */
+} Adv_Sched;
+
+void Adv_Sched_Init(Adv_Sched *sched, uint32_t now_ms);
+bool Adv_Sched_On_Connect(Adv_Sched *sched, uint32_t now_ms);
+void Adv_Sched_On_Disconnect(Adv_Sched *sched, uint32_t now_ms);
+void Adv_Sched_Next(Adv_Sched *sched, uint32_t now_ms, Adv_Sched_Params *params);
+
+#endif /* ADV_SCHED_H */
@@ -0,0 +1,199 @@
+/* BLE GATT example - connection parameter negotiation
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <string.h>      /* This is the standard C lib used for memset */
+#include "conn_params.h" /* This is the connection parameter negotiation interface */
+
+/* Link parameters requested by each profile. The supervision timeout of
+ * every profile is larger than (1 + latency) * itvl_max * 2, as the
+ * specification requires.
+ */
+static const Conn_Profile_Params Conn_Profiles[CONN_PROFILE_COUNT] = {
+    [CONN_PROFILE_LOW_LATENCY] = {.itvl_min = 6, .itvl_max = 12, .latency = 0, .supervision_timeout = 200, .tx_octets = 251, .phy = CONN_PARAMS_PHY_2M},     /* 7.5-15 ms, 2 s timeout */
+    [CONN_PROFILE_HIGH_THROUGHPUT] = {.itvl_min = 12, .itvl_max = 24, .latency = 0, .supervision_timeout = 400, .tx_octets = 251, .phy = CONN_PARAMS_PHY_2M}, /* 15-30 ms, 4 s timeout */
+    [CONN_PROFILE_LOW_POWER] = {.itvl_min = 80, .itvl_max = 160, .latency = 4, .supervision_timeout = 600, .tx_octets = 27, .phy = CONN_PARAMS_PHY_1M},      /* 100-200 ms, 6 s timeout */
+};
+
+/**
+ * @brief Link parameters requested by a profile
+ *
+ * @param profile Profile to look up
+ * @return const Conn_Profile_Params* Parameters of the profile
+ */
+const Conn_Profile_Params *Conn_Params_Profile(Conn_Profile profile)
+{
+    return &Conn_Profiles[profile < CONN_PROFILE_COUNT ? profile : CONN_PROFILE_HIGH_THROUGHPUT];
+}
+
+/**
+ * @brief Reset a link to the state of a fresh connection
+ *
+ * @param link Link to reset
+ */
+void Conn_Params_Init_Link(Conn_Link *link)
+{
+    memset(link, 0, sizeof(*link));
+    link->tx_octets = CONN_PARAMS_DEFAULT_TX_OCTETS; /* No data length extension yet */
+    link->tx_phy = CONN_PARAMS_PHY_1M;               /* Every connection starts on 1M */
+    link->rx_phy = CONN_PARAMS_PHY_1M;
+}
+
+/**
+ * @brief Record the outcome of issuing a request
+ *
+ * @param link Link the request was issued on
+ * @param request CONN_PARAMS_PENDING_* flag of the request
+ * @param rc Return code of the NimBLE call, 0 if the request went out
+ */
+void Conn_Params_Requested(Conn_Link *link, uint8_t request, int rc)
+{
+    if (rc == 0) /* Wait for the peer's answer */
+    {
+        link->pending |= request;
+        link->rejected &= ~request;
+    }
+    else /* Refused locally, for example by a controller without the feature */
+    {
+        link->rejected |= request;
+    }
+}
+
+/**
+ * @brief Record the result of a connection parameter update
+ *
+ * Also called with the initial parameters right after connecting.
+ *
+ * @param link Link that was updated
+ * @param status 0 if the update succeeded
+ * @param itvl Connection interval in use, 1.25 ms units
+ * @param latency Peripheral latency in use
+ * @param supervision_timeout Supervision timeout in use, 10 ms units
+ */
+void Conn_Params_On_Conn_Update(Conn_Link *link, int status, uint16_t itvl, uint16_t latency, uint16_t supervision_timeout)
+{
+    if (status != 0 && (link->pending & CONN_PARAMS_PENDING_UPDATE)) /* Peer turned our request down */
+    {
+        link->rejected |= CONN_PARAMS_PENDING_UPDATE;
+    }
+    link->pending &= ~CONN_PARAMS_PENDING_UPDATE;
+
+    if (status == 0 || link->itvl == 0) /* Keep the previous values if the update failed */
+    {
+        link->itvl = itvl;
+        link->latency = latency;
+        link->supervision_timeout = supervision_timeout;
+    }
+}
+
+/**
+ * @brief Record the result of a PHY update
+ *
+ * @param link Link that was updated
+ * @param status 0 if the update succeeded
+ * @param tx_phy Transmit PHY in use
+ * @param rx_phy Receive PHY in use
+ */
+void Conn_Params_On_Phy_Update(Conn_Link *link, int status, uint8_t tx_phy, uint8_t rx_phy)
+{
+    link->pending &= ~CONN_PARAMS_PENDING_PHY;
+
+    if (status != 0) /* Peer or controller refused */
+    {
+        link->rejected |= CONN_PARAMS_PENDING_PHY;
+        return;
+    }
+
+    link->tx_phy = tx_phy;
+    link->rx_phy = rx_phy;
+}
+
+/**
+ * @brief Record the completion of the MTU exchange
+ *
+ * @param link Link that was updated
+ */
+void Conn_Params_On_MTU(Conn_Link *link)
+{
+    link->pending &= ~CONN_PARAMS_PENDING_MTU;
+}
+
+/**
+ * @brief Estimate the notification throughput of a link
+ *
+ * Fills each connection event with LL PDUs of tx_octets bytes, each followed
+ * by the peer's empty acknowledgement, up to CONN_PARAMS_MAX_PDUS_PER_EVENT.
+ * The LL payload is then discounted by the L2CAP and ATT headers of an
+ * MTU sized notification.
+ *
+ * @param link Link to estimate
+ * @param mtu Negotiated ATT MTU
+ * @return uint32_t Notification value bytes per second, 0 while the interval is unknown
+ */
+uint32_t Conn_Params_Budget(const Conn_Link *link, uint16_t mtu)
+{
+    if (link->itvl == 0 || mtu <= 3) /* Not enough known yet */
+    {
+        return 0;
+    }
+
+    uint32_t itvl_us = link->itvl * 1250u;                          /* Connection interval in microseconds */
+    uint32_t bits_per_us = link->tx_phy == CONN_PARAMS_PHY_2M ? 2 : 1; /* Air rate of the PHY */
+    uint32_t pdu_us = (link->tx_octets + CONN_PARAMS_PDU_OVERHEAD) * 8 / bits_per_us + CONN_PARAMS_IFS_US /* Data PDU */
+                      + CONN_PARAMS_PDU_OVERHEAD * 8 / bits_per_us + CONN_PARAMS_IFS_US;                   /* Empty acknowledgement */
+    uint32_t pdus = itvl_us / pdu_us;                               /* PDUs that fit in one event */
+
+    if (pdus > CONN_PARAMS_MAX_PDUS_PER_EVENT)
+    {
+        pdus = CONN_PARAMS_MAX_PDUS_PER_EVENT;
+    }
+
+    uint64_t ll_bytes = (uint64_t)pdus * link->tx_octets * 1000000u / itvl_us; /* LL payload bytes per second */
+    return (uint32_t)(ll_bytes * (mtu - 3) / (mtu + 4));                       /* Minus L2CAP (4) and ATT (3) headers */
+}
+
+/**
+ * @brief Spend part of a link's notification budget
+ *
+ * Token bucket filled at throughput_bps and holding at most
+ * CONN_PARAMS_BURST_MS worth of it, but never less than one notification of
+ * the requested length. A link whose budget is not known yet is not
+ * limited.
+ *
+ * @param link Link to send on
+ * @param now_ms Current time, may wrap
+ * @param len Notification value bytes to send
+ * @return true if the notification fits the budget, which is then reduced by len
+ */
+bool Conn_Params_Budget_Take(Conn_Link *link, uint32_t now_ms, uint16_t len)
+{
+    if (link->throughput_bps == 0) /* Nothing to go by */
+    {
+        return true;
+    }
+
+    uint32_t capacity = link->throughput_bps * (uint64_t)CONN_PARAMS_BURST_MS / 1000; /* Largest burst */
+    uint64_t earned = (uint64_t)link->throughput_bps * (uint32_t)(now_ms - link->budget_ms) / 1000;
+
+    if (capacity < len)
+    {
+        capacity = len;
+    }
+    if (earned > 0) /* Leave the clock alone until a whole byte was earned */
+    {
+        uint64_t filled = link->budget_bytes + earned;
+        link->budget_bytes = filled < capacity ? (uint32_t)filled : capacity;
+        link->budget_ms = now_ms;
+    }
+
+    if (link->budget_bytes < len) /* Over budget */
+    {
+        return false;
+    }
+    link->budget_bytes -= len;
+    return true;
+}
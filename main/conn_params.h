@@ -0,0 +1,80 @@
+/* BLE GATT example - connection parameter negotiation
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef CONN_PARAMS_H
+#define CONN_PARAMS_H
+
+#include <stdbool.h> /* This is the standard C lib used for the bool type */
+#include <stdint.h>  /* This is the standard C lib used for the fixed width integer types */
+
+#define CONN_PARAMS_DEFAULT_TX_OCTETS 27  /* LL payload size before data length extension */
+#define CONN_PARAMS_PHY_1M 1              /* LE 1M PHY, as reported by the controller */
+#define CONN_PARAMS_PHY_2M 2              /* LE 2M PHY, as reported by the controller */
+#define CONN_PARAMS_PDU_OVERHEAD 10       /* Preamble, access address, header and CRC of one LL PDU */
+#define CONN_PARAMS_IFS_US 150            /* Inter frame space between PDUs */
+#define CONN_PARAMS_MAX_PDUS_PER_EVENT 6  /* PDUs the controller sends per connection event, at most */
+#define CONN_PARAMS_BURST_MS 100          /* Budget that may be saved up and sent at once */
+
+#define CONN_PARAMS_PENDING_UPDATE 0x01   /* Connection parameter update requested */
+#define CONN_PARAMS_PENDING_MTU 0x02      /* MTU exchange requested */
+#define CONN_PARAMS_PENDING_PHY 0x04      /* PHY update requested */
+#define CONN_PARAMS_PENDING_DATA_LEN 0x08 /* Data length extension, only ever rejected: no event reports its outcome */
+
+/**
+ * @brief Negotiation profile chosen for the connections
+ */
+typedef enum
+{
+    CONN_PROFILE_LOW_LATENCY,     /* Short interval, no peripheral latency */
+    CONN_PROFILE_HIGH_THROUGHPUT, /* Long LL packets on the fastest PHY */
+    CONN_PROFILE_LOW_POWER,       /* Long interval with peripheral latency */
+    CONN_PROFILE_COUNT
+} Conn_Profile;
+
+/**
+ * @brief Link parameters requested by a profile
+ */
+typedef struct
+{
+    uint16_t itvl_min;            /* Minimum connection interval, 1.25 ms units */
+    uint16_t itvl_max;            /* Maximum connection interval, 1.25 ms units */
+    uint16_t latency;             /* Peripheral latency, in connection events */
+    uint16_t supervision_timeout; /* Supervision timeout, 10 ms units */
+    uint16_t tx_octets;           /* LL payload size to request */
+    uint8_t phy;                  /* PHY to request, CONN_PARAMS_PHY_1M or CONN_PARAMS_PHY_2M */
+} Conn_Profile_Params;
+
+/**
+ * @brief Link parameters the peer actually accepted
+ */
+typedef struct
+{
+    uint16_t itvl;                /* Connection interval, 1.25 ms units, 0 until known */
+    uint16_t latency;             /* Peripheral latency, in connection events */
+    uint16_t supervision_timeout; /* Supervision timeout, 10 ms units */
+    uint16_t tx_octets;           /* LL payload size known to be in use */
+    uint16_t tx_octets_requested; /* LL payload size asked for, 0 if not requested; the peer may accept less */
+    uint8_t tx_phy;               /* Transmit PHY */
+    uint8_t rx_phy;               /* Receive PHY */
+    uint8_t pending;              /* CONN_PARAMS_PENDING_* requests not answered yet */
+    uint8_t rejected;             /* CONN_PARAMS_PENDING_* requests the peer or controller refused */
+    uint32_t throughput_bps;      /* Estimated notification payload budget, bytes per second */
+    uint32_t budget_bytes;        /* Notification bytes that may be sent now */
+    uint32_t budget_ms;           /* Time budget_bytes was last topped up */
+} Conn_Link;
+
+const Conn_Profile_Params *Conn_Params_Profile(Conn_Profile profile);
+void Conn_Params_Init_Link(Conn_Link *link);
+void Conn_Params_Requested(Conn_Link *link, uint8_t request, int rc);
+void Conn_Params_On_Conn_Update(Conn_Link *link, int status, uint16_t itvl, uint16_t latency, uint16_t supervision_timeout);
+void Conn_Params_On_Phy_Update(Conn_Link *link, int status, uint8_t tx_phy, uint8_t rx_phy);
+void Conn_Params_On_MTU(Conn_Link *link);
+uint32_t Conn_Params_Budget(const Conn_Link *link, uint16_t mtu);
+bool Conn_Params_Budget_Take(Conn_Link *link, uint32_t now_ms, uint16_t len);
+
+#endif /* CONN_PARAMS_H */
@@ -0,0 +1,269 @@
+/* BLE GATT example - per-connection state table
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <string.h>     /* This is the standard C lib used for memset */
+#include "conn_table.h" /* This is the per-connection state table interface */
+
+static Connection_State Conn_Table[CONN_TABLE_SIZE]; /* Fixed-size table, one slot per connection */
+
+/**
+ * @brief Reset a slot to its free state
+ *
+ * @param conn Slot to reset
+ */
+static void Conn_Table_Clear_Slot(Connection_State *conn)
+{
+    memset(conn, 0, sizeof(*conn));               /* Clear every field */
+    conn->conn_handle = CONN_TABLE_INVALID_HANDLE; /* Mark the handle as unused */
+    conn->mtu = CONN_TABLE_DEFAULT_MTU;            /* Start from the default ATT MTU */
+    Conn_Params_Init_Link(&conn->link);            /* Start from the default link parameters */
+}
+
+/**
+ * @brief Initialise the connection table
+ *
+ * Marks every slot as free. Must be called before the NimBLE host starts.
+ */
+void Conn_Table_Init(void)
+{
+    for (size_t i = 0; i < CONN_TABLE_SIZE; i++) /* Walk every slot */
+    {
+        Conn_Table_Clear_Slot(&Conn_Table[i]); /* Free the slot */
+    }
+}
+
+/**
+ * @brief Find the slot holding a connection
+ *
+ * @param conn_handle Connection handle to look up
+ * @return Connection_State* Slot for the connection, or NULL if it is not tracked
+ */
+Connection_State *Conn_Table_Find(uint16_t conn_handle)
+{
+    for (size_t i = 0; i < CONN_TABLE_SIZE; i++) /* Walk every slot */
+    {
+        if (Conn_Table[i].in_use && Conn_Table[i].conn_handle == conn_handle) /* Match a live slot by handle */
+        {
+            return &Conn_Table[i];
+        }
+    }
+    return NULL; /* Connection is not tracked */
+}
+
+/**
+ * @brief Position of a slot in the table
+ *
+ * Lets other modules keep per-connection state of their own in arrays of
+ * CONN_TABLE_SIZE entries.
+ *
+ * @param conn Slot returned by Conn_Table_Add or Conn_Table_Find
+ * @return size_t Index of the slot, below CONN_TABLE_SIZE
+ */
+size_t Conn_Table_Index(const Connection_State *conn)
+{
+    return (size_t)(conn - Conn_Table);
+}
+
+/**
+ * @brief Claim a slot for a new connection
+ *
+ * If the handle is already tracked its existing slot is reset and reused.
+ *
+ * @param conn_handle Connection handle reported by BLE_GAP_EVENT_CONNECT
+ * @return Connection_State* Claimed slot, or NULL if the table is full
+ */
+Connection_State *Conn_Table_Add(uint16_t conn_handle)
+{
+    Connection_State *conn = Conn_Table_Find(conn_handle); /* Reuse the slot if the handle is stale */
+
+    for (size_t i = 0; conn == NULL && i < CONN_TABLE_SIZE; i++) /* Otherwise look for a free slot */
+    {
+        if (!Conn_Table[i].in_use)
+        {
+            conn = &Conn_Table[i];
+        }
+    }
+
+    if (conn == NULL) /* Table is full */
+    {
+        return NULL;
+    }
+
+    Conn_Table_Clear_Slot(conn);     /* Start from a clean state */
+    conn->conn_handle = conn_handle; /* Save the connection handle */
+    conn->in_use = true;             /* Mark the slot as live */
+    return conn;
+}
+
+/**
+ * @brief Release the slot of a closed connection
+ *
+ * @param conn_handle Connection handle reported by BLE_GAP_EVENT_DISCONNECT
+ */
+void Conn_Table_Remove(uint16_t conn_handle)
+{
+    Connection_State *conn = Conn_Table_Find(conn_handle); /* Look up the slot */
+
+    if (conn != NULL)
+    {
+        Conn_Table_Clear_Slot(conn); /* Free the slot */
+    }
+}
+
+/**
+ * @brief Update the battery level client configuration of a connection
+ *
+ * Enabling notifications makes the current level due for this connection.
+ *
+ * @param conn_handle Connection handle
+ * @param cccd New client configuration value (bit 0: notify)
+ * @return true if the connection is tracked, false otherwise
+ */
+bool Conn_Table_Set_Battery_CCCD(uint16_t conn_handle, uint16_t cccd)
+{
+    Connection_State *conn = Conn_Table_Find(conn_handle); /* Look up the slot */
+
+    if (conn == NULL)
+    {
+        return false;
+    }
+
+    if ((cccd & CONN_TABLE_CCCD_NOTIFY) && !(conn->battery_cccd & CONN_TABLE_CCCD_NOTIFY)) /* Notifications just enabled */
+    {
+        Value_Pub_Reset_Conn(&conn->battery); /* Send the current level on the next publish */
+    }
+    conn->battery_cccd = cccd; /* Save the client configuration */
+    return true;
+}
+
+/**
+ * @brief Update the sensor stream subscription of a connection
+ *
+ * @param conn_handle Connection handle
+ * @param notify true if the connection enabled notifications on the stream
+ * @return true if the connection is tracked, false otherwise
+ */
+bool Conn_Table_Set_Stream_Notify(uint16_t conn_handle, bool notify)
+{
+    Connection_State *conn = Conn_Table_Find(conn_handle); /* Look up the slot */
+
+    if (conn == NULL)
+    {
+        return false;
+    }
+
+    conn->stream_notify = notify; /* Save the subscription */
+    return true;
+}
+
+/**
+ * @brief Update the negotiated ATT MTU of a connection
+ *
+ * @param conn_handle Connection handle
+ * @param mtu MTU reported by BLE_GAP_EVENT_MTU
+ * @return true if the connection is tracked, false otherwise
+ */
+bool Conn_Table_Set_MTU(uint16_t conn_handle, uint16_t mtu)
+{
+    Connection_State *conn = Conn_Table_Find(conn_handle); /* Look up the slot */
+
+    if (conn == NULL)
+    {
+        return false;
+    }
+
+    conn->mtu = mtu;                                          /* Save the negotiated MTU */
+    Conn_Params_On_MTU(&conn->link);                          /* MTU exchange is done */
+    conn->link.throughput_bps = Conn_Params_Budget(&conn->link, mtu); /* Larger notifications change the budget */
+    return true;
+}
+
+/**
+ * @brief Count the live connections
+ *
+ * @return size_t Number of slots in use
+ */
+size_t Conn_Table_Count(void)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < CONN_TABLE_SIZE; i++) /* Walk every slot */
+    {
+        if (Conn_Table[i].in_use)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Count the connections subscribed to battery level notifications
+ *
+ * @return size_t Number of subscribed connections
+ */
+size_t Conn_Table_Subscribed_Count(void)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < CONN_TABLE_SIZE; i++) /* Walk every slot */
+    {
+        if (Conn_Table[i].in_use && (Conn_Table[i].battery_cccd & CONN_TABLE_CCCD_NOTIFY)) /* Live and notify bit set */
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Visit every live connection
+ *
+ * @param visit Callback invoked for each live connection
+ * @param arg User-defined argument passed to the callback
+ * @return size_t Number of connections visited
+ */
+size_t Conn_Table_For_Each(Conn_Table_Visit_Fn visit, void *arg)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < CONN_TABLE_SIZE; i++) /* Walk every slot */
+    {
+        if (Conn_Table[i].in_use)
+        {
+            visit(&Conn_Table[i], arg); /* Hand the slot to the caller */
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Visit every connection subscribed to battery level notifications
+ *
+ * Walks the table once so a single timer tick can fan a notification out to
+ * every subscribed central.
+ *
+ * @param visit Callback invoked for each subscribed connection
+ * @param arg User-defined argument passed to the callback
+ * @return size_t Number of connections visited
+ */
+size_t Conn_Table_For_Each_Subscribed(Conn_Table_Visit_Fn visit, void *arg)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < CONN_TABLE_SIZE; i++) /* Walk every slot */
+    {
+        if (Conn_Table[i].in_use && (Conn_Table[i].battery_cccd & CONN_TABLE_CCCD_NOTIFY)) /* Live and notify bit set */
+        {
+            visit(&Conn_Table[i], arg); /* Hand the slot to the caller */
+            count++;
+        }
+    }
+    return count;
+}
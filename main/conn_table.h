@@ -0,0 +1,76 @@
+/* BLE GATT example - per-connection state table
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef CONN_TABLE_H
+#define CONN_TABLE_H
+
+#include <stdbool.h> /* This is the standard C lib used for the bool type */
+#include <stddef.h>  /* This is the standard C lib used for the size_t type */
+#include <stdint.h>  /* This is the standard C lib used for the fixed width integer types */
+#include "conn_params.h" /* This is the connection parameter negotiation, for the per-link state */
+#include "value_pub.h"   /* This is the value publishing, for the per-connection battery state */
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h" /* This is ESP generated config used for the NimBLE connection limit */
+#endif
+
+#ifndef CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+#define CONFIG_BT_NIMBLE_MAX_CONNECTIONS 3 /* Fallback for builds without sdkconfig.h */
+#endif
+
+#define CONN_TABLE_SIZE CONFIG_BT_NIMBLE_MAX_CONNECTIONS /* One slot per connection the host can hold */
+#define CONN_TABLE_INVALID_HANDLE 0xFFFF                 /* Connection handle stored in a free slot */
+#define CONN_TABLE_DEFAULT_MTU 23                        /* ATT MTU before any MTU exchange */
+#define CONN_TABLE_CCCD_NOTIFY 0x0001                    /* Client configuration bit enabling notifications */
+
+/**
+ * @brief State tracked for one connected central
+ *
+ * A slot is claimed on BLE_GAP_EVENT_CONNECT and released on
+ * BLE_GAP_EVENT_DISCONNECT. The battery CCCD value is kept per connection so
+ * that one central unsubscribing does not silence the others. The table has
+ * no lock and must only be used from the NimBLE host task; timer work that
+ * walks it is posted to the host's event queue (see Gatt_Svr_Init).
+ */
+typedef struct
+{
+    bool in_use;                 /* Slot holds a live connection */
+    uint16_t conn_handle;        /* NimBLE connection handle */
+    uint16_t mtu;                /* Negotiated ATT MTU */
+    uint16_t battery_cccd;       /* Client configuration for the battery level characteristic (bit 0: notify) */
+    Value_Pub_Conn battery;      /* Battery level last notified to this connection */
+    bool stream_notify;          /* Subscribed to the sensor stream characteristic */
+    Conn_Link link;              /* Link parameters the peer accepted and the resulting throughput budget */
+    uint32_t bytes_in;           /* Value bytes written by this connection */
+    uint32_t bytes_out;          /* Value bytes notified to this connection */
+    uint16_t diag_served;        /* Bytes of the cached diagnostics snapshot already read, 0 when no long read is under way */
+    uint32_t diag_read_ms;       /* Time of the last read of the diagnostics snapshot */
+} Connection_State;
+
+/**
+ * @brief Callback used by Conn_Table_For_Each and Conn_Table_For_Each_Subscribed
+ *
+ * @param conn Connection slot being visited
+ * @param arg User-defined argument
+ */
+typedef void (*Conn_Table_Visit_Fn)(Connection_State *conn, void *arg);
+
+void Conn_Table_Init(void);
+Connection_State *Conn_Table_Add(uint16_t conn_handle);
+void Conn_Table_Remove(uint16_t conn_handle);
+Connection_State *Conn_Table_Find(uint16_t conn_handle);
+bool Conn_Table_Set_Battery_CCCD(uint16_t conn_handle, uint16_t cccd);
+bool Conn_Table_Set_Stream_Notify(uint16_t conn_handle, bool notify);
+bool Conn_Table_Set_MTU(uint16_t conn_handle, uint16_t mtu);
+size_t Conn_Table_Index(const Connection_State *conn);
+size_t Conn_Table_Count(void);
+size_t Conn_Table_Subscribed_Count(void);
+size_t Conn_Table_For_Each(Conn_Table_Visit_Fn visit, void *arg);
+size_t Conn_Table_For_Each_Subscribed(Conn_Table_Visit_Fn visit, void *arg);
+
+#endif /* CONN_TABLE_H */
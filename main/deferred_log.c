@@ -0,0 +1,190 @@
+/* BLE GATT example - deferred logging
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <esp_log.h>           /* This is ESP lib used to print the records */
+#include <freertos/FreeRTOS.h> /* This is ESP lib used for the FreeRTOS types */
+#include <freertos/task.h>     /* This is ESP lib used to create the flush task and identify the calling task */
+#include "deferred_log.h"      /* This is the deferred logging interface */
+#include "spsc_ring.h"         /* This is the lock-free ring between the tasks */
+#include "diag.h"              /* This is the runtime performance counters, for the drop count */
+
+/**
+ * @brief One ring slot holding a message waiting to be formatted
+ */
+typedef struct
+{
+    uint16_t id;                         /* Deferred_Log_Id of the message */
+    int32_t args[DEFERRED_LOG_MAX_ARGS]; /* Raw arguments, formatted by the flush task */
+} Deferred_Log_Record;
+
+static Deferred_Log_Record Deferred_Log_Records[DEFERRED_LOG_CHANNEL_COUNT][DEFERRED_LOG_RING_SLOTS]; /* Storage of the rings */
+static Spsc_Ring Deferred_Log_Rings[DEFERRED_LOG_CHANNEL_COUNT];                                        /* One ring per producer task */
+static _Atomic(TaskHandle_t) Deferred_Log_Owners[DEFERRED_LOG_CHANNEL_COUNT];                           /* Task owning each channel, NULL until registered */
+
+/* Select the first `count` arguments of a record, each preceded by a comma */
+#define DEFERRED_LOG_ARGS_0(a)
+#define DEFERRED_LOG_ARGS_1(a) , (int)(a)[0]
+#define DEFERRED_LOG_ARGS_2(a) , (int)(a)[0], (int)(a)[1]
+#define DEFERRED_LOG_ARGS_3(a) , (int)(a)[0], (int)(a)[1], (int)(a)[2]
+
+/* Expands the selected arguments before ESP_LOG_LEVEL_LOCAL splits them */
+#define DEFERRED_LOG_EMIT(...) ESP_LOG_LEVEL_LOCAL(__VA_ARGS__)
+
+/**
+ * @brief Format and print one record
+ *
+ * Each message gets its own ESP_LOG_LEVEL_LOCAL call so the format string
+ * stays a literal and is checked against its arguments at compile time.
+ * The timestamp printed is the time of the flush, not of the call.
+ *
+ * @param record Record to print
+ */
+static void Deferred_Log_Print(const Deferred_Log_Record *record)
+{
+    switch (record->id)
+    {
+#define DEFERRED_LOG_CASE(id, level, tag, format, count)                               \
+    case id:                                                                           \
+        DEFERRED_LOG_EMIT(level, tag, format DEFERRED_LOG_ARGS_##count(record->args)); \
+        break;
+        DEFERRED_LOG_MESSAGES(DEFERRED_LOG_CASE)
+#undef DEFERRED_LOG_CASE
+
+    default: /* Unknown identifier, nothing to print */
+        break;
+    }
+}
+
+/**
+ * @brief Flush task draining every channel
+ *
+ * Prints the queued records of each channel in place, releases them to the
+ * producer in one batch, reports records lost since the last pass, then
+ * sleeps for DEFERRED_LOG_FLUSH_MS once every ring is empty. The producers
+ * never wake it, so a record waits at most that long to be printed and a
+ * ring fills only if a task logs more than DEFERRED_LOG_RING_SLOTS records
+ * in that time. Records of different channels are not interleaved by time.
+ *
+ * @param param Pointer to the task's parameter (unused)
+ */
+static void Deferred_Log_Task(void *param)
+{
+    uint32_t reported = 0; /* Drops already reported */
+
+    for (;;)
+    {
+        bool idle = true; /* No channel had anything queued */
+
+        for (size_t channel = 0; channel < DEFERRED_LOG_CHANNEL_COUNT; channel++) /* Drain every channel */
+        {
+            size_t count;
+            Deferred_Log_Record *records = Spsc_Ring_Peek(&Deferred_Log_Rings[channel], &count); /* Look at the queued records */
+
+            if (records == NULL) /* Nothing queued on this channel */
+            {
+                continue;
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                Deferred_Log_Print(&records[i]); /* Format and print the record */
+            }
+            Spsc_Ring_Release(&Deferred_Log_Rings[channel], count); /* Give the slots back to the producer */
+            idle = false;
+        }
+
+        uint32_t dropped = Deferred_Log_Dropped();
+        if (dropped != reported) /* Some records never made it into a ring */
+        {
+            ESP_LOGW("LOG", "%u log records dropped", (unsigned)(dropped - reported));
+            reported = dropped;
+        }
+
+        if (idle) /* Everything printed */
+        {
+            vTaskDelay(pdMS_TO_TICKS(DEFERRED_LOG_FLUSH_MS)); /* Poll the rings again later */
+        }
+    }
+}
+
+/**
+ * @brief Create the rings and the flush task
+ *
+ * The NimBLE host task registers itself with Deferred_Log_Register_Task
+ * once it runs. Must be called before any task logs through Deferred_Log.
+ */
+void Deferred_Log_Init(void)
+{
+    for (size_t channel = 0; channel < DEFERRED_LOG_CHANNEL_COUNT; channel++) /* One ring per channel */
+    {
+        Spsc_Ring_Init(&Deferred_Log_Rings[channel], Deferred_Log_Records[channel], sizeof(Deferred_Log_Record), DEFERRED_LOG_RING_SLOTS);
+    }
+    xTaskCreatePinnedToCore(Deferred_Log_Task, "Deferred_Log_Task", DEFERRED_LOG_TASK_STACK_SIZE, NULL,
+                            DEFERRED_LOG_TASK_PRIORITY, NULL, DEFERRED_LOG_TASK_CORE); /* Start the flush task away from the host task */
+}
+
+/**
+ * @brief Make the calling task the producer of a channel
+ *
+ * Called by the task itself, before its first Deferred_Log call. Calls
+ * from tasks that own no channel are dropped.
+ *
+ * @param channel Channel the calling task writes to
+ */
+void Deferred_Log_Register_Task(Deferred_Log_Channel channel)
+{
+    atomic_store_explicit(&Deferred_Log_Owners[channel], xTaskGetCurrentTaskHandle(), memory_order_relaxed);
+}
+
+/**
+ * @brief Log a message without formatting it
+ *
+ * Copies the identifier and the raw arguments into the ring of the channel
+ * owned by the calling task, where the polling flush task finds it: no
+ * task is woken and nothing is waited for. If the ring is full, or the
+ * calling task owns no channel, the record is dropped and counted. Unused
+ * arguments are ignored.
+ *
+ * @param id Message to log
+ * @param arg0 First argument
+ * @param arg1 Second argument
+ * @param arg2 Third argument
+ */
+void Deferred_Log(Deferred_Log_Id id, int32_t arg0, int32_t arg1, int32_t arg2)
+{
+    const Deferred_Log_Record record = {id, {arg0, arg1, arg2}};
+    TaskHandle_t task = xTaskGetCurrentTaskHandle(); /* Producer of the record */
+    size_t channel = 0;
+
+    while (channel < DEFERRED_LOG_CHANNEL_COUNT && atomic_load_explicit(&Deferred_Log_Owners[channel], memory_order_relaxed) != task) /* Find the caller's channel */
+    {
+        channel++;
+    }
+
+    if (channel == DEFERRED_LOG_CHANNEL_COUNT) /* No channel of its own, it would be a second producer */
+    {
+        Diag_Count(DIAG_LOG_UNREGISTERED);
+        return;
+    }
+
+    if (Spsc_Ring_Push(&Deferred_Log_Rings[channel], &record, 1) == 0) /* Ring full */
+    {
+        Diag_Count(DIAG_LOG_DROPPED);
+    }
+}
+
+/**
+ * @brief Number of records dropped so far
+ *
+ * @return uint32_t Records lost because their channel's ring was full or the calling task owned no channel
+ */
+uint32_t Deferred_Log_Dropped(void)
+{
+    return atomic_load_explicit(&Diag_Counters[DIAG_LOG_DROPPED], memory_order_relaxed) +
+           atomic_load_explicit(&Diag_Counters[DIAG_LOG_UNREGISTERED], memory_order_relaxed);
+}
@@ -0,0 +1,70 @@
+/* BLE GATT example - deferred logging
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stdint.h> /* This is the standard C lib used for the fixed width integer types */
+
+#define DEFERRED_LOG_MAX_ARGS 3           /* Integer arguments carried by one record */
+#define DEFERRED_LOG_RING_SLOTS 32        /* Records each channel can hold, a power of two */
+#define DEFERRED_LOG_TASK_STACK_SIZE 2560 /* Stack size of the flush task */
+#define DEFERRED_LOG_TASK_PRIORITY 1      /* Flush task priority, below the NimBLE host task */
+#define DEFERRED_LOG_TASK_CORE 1          /* Flush task core, away from the NimBLE host task on core 0 */
+#define DEFERRED_LOG_FLUSH_MS 10          /* Time the flush task sleeps once every ring is empty */
+
+/*
+ * Every message that can be logged through the deferred log:
+ * X(id, level, tag, format, argument count)
+ *
+ * Arguments are passed as int32_t and printed with %d, so formats must only
+ * use %d; strings cannot be deferred because the caller's buffer may be gone
+ * by the time the record is formatted.
+ */
+#define DEFERRED_LOG_MESSAGES(X)                                                                                      \
+    X(LOG_GAP_CONNECT, ESP_LOG_INFO, "GAP", "BLE_GAP_EVENT_CONNECT status %d", 1)                                      \
+    X(LOG_GAP_RECONNECT, ESP_LOG_INFO, "GAP", "Reconnected %d ms after disconnect", 1)                                 \
+    X(LOG_GAP_TABLE_FULL, ESP_LOG_WARN, "GAP", "Connection table full, handle %d refused", 1)                          \
+    X(LOG_GAP_DISCONNECT, ESP_LOG_INFO, "GAP", "BLE_GAP_EVENT_DISCONNECT reason %d", 1)                                \
+    X(LOG_GAP_ADV_COMPLETE, ESP_LOG_INFO, "GAP", "BLE_GAP_EVENT_ADV_COMPLETE", 0)                                      \
+    X(LOG_GAP_SUBSCRIBE, ESP_LOG_INFO, "GAP", "BLE_GAP_EVENT_SUBSCRIBE handle %d notify %d", 2)                        \
+    X(LOG_GAP_MTU, ESP_LOG_INFO, "GAP", "BLE_GAP_EVENT_MTU %d", 1)                                                     \
+    X(LOG_GAP_CONN_UPDATE, ESP_LOG_INFO, "GAP", "BLE_GAP_EVENT_CONN_UPDATE status %d, interval %d, budget %d B/s", 3) \
+    X(LOG_GAP_PHY_UPDATE, ESP_LOG_INFO, "GAP", "BLE_GAP_EVENT_PHY_UPDATE_COMPLETE tx %d rx %d", 2)                     \
+    X(LOG_BATTERY_LEVEL, ESP_LOG_INFO, "BATTERY", "Reporting battery level %d (%d updates, %d notifications)", 3)
+
+/**
+ * @brief Message identifiers, one per DEFERRED_LOG_MESSAGES entry
+ */
+typedef enum
+{
+#define DEFERRED_LOG_ID(id, level, tag, format, args) id,
+    DEFERRED_LOG_MESSAGES(DEFERRED_LOG_ID)
+#undef DEFERRED_LOG_ID
+        LOG_MESSAGE_COUNT
+} Deferred_Log_Id;
+
+/**
+ * @brief Producer contexts, each with its own single producer ring
+ *
+ * Each channel is owned by one task, registered with
+ * Deferred_Log_Register_Task, and Deferred_Log picks the ring of the task
+ * it is called from, so that each ring keeps exactly one producer.
+ */
+typedef enum
+{
+    DEFERRED_LOG_HOST, /* NimBLE host task: GAP events, GATT access callbacks and the work posted by the timers */
+    DEFERRED_LOG_CHANNEL_COUNT
+} Deferred_Log_Channel;
+
+void Deferred_Log_Init(void);
+void Deferred_Log_Register_Task(Deferred_Log_Channel channel);
+void Deferred_Log(Deferred_Log_Id id, int32_t arg0, int32_t arg1, int32_t arg2);
+uint32_t Deferred_Log_Dropped(void);
+
+#endif /* DEFERRED_LOG_H */
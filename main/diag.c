@@ -0,0 +1,169 @@
+/* BLE GATT example - runtime performance counters
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include "diag.h"        /* This is the runtime performance counters interface */
+#include "notify_pool.h" /* This is the notification buffer pool, for its usage counters */
+
+atomic_uint Diag_Counters[DIAG_COUNTER_COUNT];                        /* Storage of the event counters */
+static atomic_uint Diag_Callback_Histogram[DIAG_HISTOGRAM_BUCKETS]; /* Callback execution times, log2 microsecond buckets */
+static atomic_uint Diag_Reconnect_Count;                             /* Reconnects measured */
+static atomic_uint Diag_Reconnect_Last_Ms;                           /* Latency of the most recent reconnect */
+static atomic_uint Diag_Reconnect_Max_Ms;                            /* Longest reconnect latency seen */
+
+/**
+ * @brief Record how long a callback ran
+ *
+ * @param elapsed_us Execution time in microseconds
+ */
+void Diag_Record_Callback_Time(uint32_t elapsed_us)
+{
+    unsigned bucket = 0;
+
+    while (elapsed_us != 0 && bucket < DIAG_HISTOGRAM_BUCKETS - 1) /* Index of the highest set bit, plus one */
+    {
+        elapsed_us >>= 1;
+        bucket++;
+    }
+
+    atomic_fetch_add_explicit(&Diag_Callback_Histogram[bucket], 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Record the time from a disconnect to the next connect
+ *
+ * @param latency_ms Reconnect latency in milliseconds
+ */
+void Diag_Record_Reconnect(uint32_t latency_ms)
+{
+    unsigned max = atomic_load_explicit(&Diag_Reconnect_Max_Ms, memory_order_relaxed);
+
+    while (latency_ms > max && !atomic_compare_exchange_weak_explicit(&Diag_Reconnect_Max_Ms, &max, latency_ms,
+                                                                      memory_order_relaxed, memory_order_relaxed)) /* Raise the maximum */
+    {
+    }
+
+    atomic_store_explicit(&Diag_Reconnect_Last_Ms, latency_ms, memory_order_relaxed);
+    atomic_fetch_add_explicit(&Diag_Reconnect_Count, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Write a little endian 16-bit value
+ *
+ * @param dst Destination
+ * @param value Value to write
+ * @return uint8_t* Byte following the value
+ */
+static uint8_t *Diag_Put_U16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = value & 0xFF;
+    dst[1] = value >> 8;
+    return dst + 2;
+}
+
+/**
+ * @brief Write a little endian 32-bit value
+ *
+ * @param dst Destination
+ * @param value Value to write
+ * @return uint8_t* Byte following the value
+ */
+static uint8_t *Diag_Put_U32(uint8_t *dst, uint32_t value)
+{
+    dst[0] = value & 0xFF;
+    dst[1] = (value >> 8) & 0xFF;
+    dst[2] = (value >> 16) & 0xFF;
+    dst[3] = value >> 24;
+    return dst + 4;
+}
+
+/**
+ * @brief Context of the per-connection part of a snapshot
+ */
+typedef struct
+{
+    uint8_t *dst;   /* Next byte to write */
+    uint8_t *count; /* Byte holding the number of connections written */
+} Diag_Conn_Writer;
+
+/**
+ * @brief Append one connection to a snapshot
+ *
+ * @param conn Connection being visited
+ * @param arg Pointer to the Diag_Conn_Writer
+ */
+static void Diag_Put_Connection(Connection_State *conn, void *arg)
+{
+    Diag_Conn_Writer *writer = arg;
+
+    writer->dst = Diag_Put_U16(writer->dst, conn->conn_handle);
+    writer->dst = Diag_Put_U16(writer->dst, conn->mtu);
+    writer->dst = Diag_Put_U32(writer->dst, conn->bytes_in);
+    writer->dst = Diag_Put_U32(writer->dst, conn->bytes_out);
+    (*writer->count)++;
+}
+
+/**
+ * @brief Serialise every counter into a compact binary snapshot
+ *
+ * All values are little endian:
+ *   u8  version (DIAG_SNAPSHOT_VERSION)
+ *   u8  number of connections N
+ *   u32 counters[DIAG_COUNTER_COUNT], in Diag_Counter order
+ *   u32 reconnect count, last latency (ms), maximum latency (ms)
+ *   u32 callback histogram[DIAG_HISTOGRAM_BUCKETS]
+ *   u32 notification pool allocations, failures
+ *   u16 notification pool blocks in use, peak in use, total blocks
+ *   N x { u16 handle, u16 mtu, u32 bytes in, u32 bytes out }
+ *
+ * Counters keep running while the snapshot is taken, so values are each
+ * exact but not taken at a single instant. The pool and connection parts
+ * are only consistent when called from the NimBLE host task.
+ *
+ * @param buf Output buffer
+ * @param len Size of the output buffer, at least DIAG_SNAPSHOT_MAX_SIZE
+ * @return size_t Bytes written, 0 if the buffer is too small
+ */
+size_t Diag_Snapshot(uint8_t *buf, size_t len)
+{
+    if (len < DIAG_SNAPSHOT_MAX_SIZE)
+    {
+        return 0;
+    }
+
+    uint8_t *dst = buf;
+    *dst++ = DIAG_SNAPSHOT_VERSION;
+
+    Diag_Conn_Writer writer = {.count = dst++};
+    *writer.count = 0;
+
+    for (size_t i = 0; i < DIAG_COUNTER_COUNT; i++)
+    {
+        dst = Diag_Put_U32(dst, atomic_load_explicit(&Diag_Counters[i], memory_order_relaxed));
+    }
+
+    dst = Diag_Put_U32(dst, atomic_load_explicit(&Diag_Reconnect_Count, memory_order_relaxed));
+    dst = Diag_Put_U32(dst, atomic_load_explicit(&Diag_Reconnect_Last_Ms, memory_order_relaxed));
+    dst = Diag_Put_U32(dst, atomic_load_explicit(&Diag_Reconnect_Max_Ms, memory_order_relaxed));
+
+    for (size_t i = 0; i < DIAG_HISTOGRAM_BUCKETS; i++)
+    {
+        dst = Diag_Put_U32(dst, atomic_load_explicit(&Diag_Callback_Histogram[i], memory_order_relaxed));
+    }
+
+    Notify_Pool_Stats pool;
+    Notify_Pool_Get_Stats(&pool); /* Notification buffer usage */
+    dst = Diag_Put_U32(dst, pool.allocations);
+    dst = Diag_Put_U32(dst, pool.failures);
+    dst = Diag_Put_U16(dst, pool.in_use);
+    dst = Diag_Put_U16(dst, pool.peak_in_use);
+    dst = Diag_Put_U16(dst, pool.block_count);
+
+    writer.dst = dst;
+    Conn_Table_For_Each(Diag_Put_Connection, &writer); /* Per-connection bytes in and out */
+    return writer.dst - buf;
+}
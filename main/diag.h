@@ -0,0 +1,57 @@
+/* BLE GATT example - runtime performance counters
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef DIAG_H
+#define DIAG_H
+
+#include <stdatomic.h>  /* This is the standard C lib used for the lock-free counters */
+#include <stddef.h>     /* This is the standard C lib used for the size_t type */
+#include <stdint.h>     /* This is the standard C lib used for the fixed width integer types */
+#include "conn_table.h" /* This is the per-connection state table, used to size the snapshot */
+
+#define DIAG_SNAPSHOT_VERSION 5   /* Layout version, first byte of every snapshot */
+#define DIAG_HISTOGRAM_BUCKETS 16 /* Callback time buckets: [0,1) us, [1,2) us, [2,4) us ... [16.4 ms, inf) */
+
+/**
+ * @brief Event counters
+ */
+typedef enum
+{
+    DIAG_NOTIFY_SENT,        /* Notifications handed to the host */
+    DIAG_NOTIFY_FAILED,      /* Notifications that could not be sent */
+    DIAG_MBUF_ALLOC_FAILED,  /* Notification buffers the pool could not provide */
+    DIAG_WRITE_RECEIVED,     /* Writes to the custom characteristic */
+    DIAG_WRITE_DROPPED,      /* Writes refused because the ingest ring was full */
+    DIAG_LOG_DROPPED,        /* Deferred log records lost because their ring was full */
+    DIAG_LOG_UNREGISTERED,   /* Deferred log records lost because the calling task owned no channel */
+    DIAG_STREAM_OVER_BUDGET, /* Sensor stream frames not sent because the link's budget was spent */
+    DIAG_COUNTER_COUNT
+} Diag_Counter;
+
+#define DIAG_SNAPSHOT_MAX_SIZE (2 + (DIAG_COUNTER_COUNT + 3 + DIAG_HISTOGRAM_BUCKETS + 2) * 4 + 3 * 2 + CONN_TABLE_SIZE * 12) /* Upper bound of Diag_Snapshot output, layout in diag.c */
+
+extern atomic_uint Diag_Counters[DIAG_COUNTER_COUNT]; /* Storage of the event counters */
+
+/**
+ * @brief Count one event
+ *
+ * A single relaxed atomic add, safe from any task and cheap enough to leave
+ * on in production.
+ *
+ * @param counter Event to count
+ */
+static inline void Diag_Count(Diag_Counter counter)
+{
+    atomic_fetch_add_explicit(&Diag_Counters[counter], 1, memory_order_relaxed);
+}
+
+void Diag_Record_Callback_Time(uint32_t elapsed_us);
+void Diag_Record_Reconnect(uint32_t latency_ms);
+size_t Diag_Snapshot(uint8_t *buf, size_t len);
+
+#endif /* DIAG_H */
@@ -0,0 +1,325 @@
+/* BLE GATT example - GAP event handling and advertising
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <string.h>       /* This is the standard C lib used for memset */
+#include <esp_log.h>      /* This is ESP lib used to log the errors */
+#include <esp_timer.h>    /* This is ESP lib used for the monotonic clock of the advertising scheduler */
+#include <host/ble_hs.h>  /* This is ESP lib used for the ble host controller */
+#include "gap_svr.h"      /* This is the GAP event handling interface */
+#include "gatt_svr.h"     /* This is the GATT services, told about subscriptions and closed connections */
+#include "conn_table.h"   /* This is the per-connection state table */
+#include "adv_sched.h"    /* This is the adaptive advertising scheduler */
+#include "conn_params.h"  /* This is the connection parameter negotiation */
+#include "diag.h"         /* This is the runtime performance counters */
+#include "deferred_log.h" /* This is the deferred logging */
+
+#define BLE_CONN_PROFILE CONN_PROFILE_HIGH_THROUGHPUT /* Define the link parameters requested from every central */
+
+uint8_t BLE_Addr_Type; /* Variable to hold the BLE address type */
+
+static uint8_t Adv_Data[BLE_HS_ADV_MAX_SZ];      /* Encoded advertising payload, built once per host sync */
+static uint8_t Adv_Data_Len;                     /* Length of the encoded advertising payload */
+static uint8_t Scan_Rsp_Data[BLE_HS_ADV_MAX_SZ]; /* Encoded scan response payload, built once per host sync */
+static uint8_t Scan_Rsp_Data_Len;                /* Length of the encoded scan response payload */
+static Adv_Sched Adv_Scheduler;                  /* Chooses fast or power saving advertising intervals */
+
+/* Custom service UUID advertised in the scan response, so centrals can filter on it */
+static const ble_uuid128_t Custom_Service_UUID = BLE_UUID128_INIT(0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff);
+
+/**
+ * @brief Current time for the advertising scheduler
+ *
+ * @return uint32_t Milliseconds since boot, wrapping
+ */
+static uint32_t BLE_app_now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000); /* esp_timer counts microseconds */
+}
+
+/**
+ * @brief Refresh the link parameters of a connection from the controller
+ *
+ * @param conn Connection to refresh
+ * @param status Status of the event that triggered the refresh, 0 on success
+ */
+static void BLE_app_link_refresh(Connection_State *conn, int status)
+{
+    struct ble_gap_conn_desc desc; /* Parameters the controller is using */
+
+    if (ble_gap_conn_find(conn->conn_handle, &desc) == 0)
+    {
+        Conn_Params_On_Conn_Update(&conn->link, status, desc.conn_itvl, desc.conn_latency, desc.supervision_timeout);
+    }
+    conn->link.throughput_bps = Conn_Params_Budget(&conn->link, conn->mtu); /* Recompute the notification budget */
+}
+
+/**
+ * @brief Negotiate the link parameters of a new connection
+ *
+ * Issues, for the BLE_CONN_PROFILE profile, a connection parameter update,
+ * an MTU exchange, a data length extension and, where the profile asks for
+ * it, a switch to the 2M PHY. Each answer arrives later as a GAP event and
+ * is recorded in the connection's link state; requests the controller
+ * refuses straight away (e.g. 2M PHY on a Bluetooth 4.2 controller) are
+ * recorded as rejected. The NimBLE host of ESP-IDF 4.3 raises no event for
+ * the data length change, so that request is never left pending.
+ *
+ * @param conn Connection that was just established
+ */
+static void BLE_app_negotiate(Connection_State *conn)
+{
+    const Conn_Profile_Params *profile = Conn_Params_Profile(BLE_CONN_PROFILE); /* Parameters to ask for */
+
+    BLE_app_link_refresh(conn, 0); /* Start from the parameters the central chose */
+
+    struct ble_gap_upd_params params;                          /* Declare connection parameters */
+    memset(&params, 0, sizeof(params));                        /* Clear the connection parameters structure */
+    params.itvl_min = profile->itvl_min;                       /* Set the minimum connection interval */
+    params.itvl_max = profile->itvl_max;                       /* Set the maximum connection interval */
+    params.latency = profile->latency;                         /* Set the peripheral latency */
+    params.supervision_timeout = profile->supervision_timeout; /* Set the supervision timeout */
+    Conn_Params_Requested(&conn->link, CONN_PARAMS_PENDING_UPDATE, ble_gap_update_params(conn->conn_handle, &params));
+
+    Conn_Params_Requested(&conn->link, CONN_PARAMS_PENDING_MTU, ble_gattc_exchange_mtu(conn->conn_handle, NULL, NULL));
+
+    int rc = ble_gap_set_data_len(conn->conn_handle, profile->tx_octets, (profile->tx_octets + 14) * 8); /* Time of the longest PDU on 1M */
+    if (rc == 0) /* The host is not told what the peer accepted, so tx_octets stays at the size known to be in use */
+    {
+        conn->link.tx_octets_requested = profile->tx_octets;
+    }
+    else
+    {
+        conn->link.rejected |= CONN_PARAMS_PENDING_DATA_LEN;
+    }
+
+    if (profile->phy == CONN_PARAMS_PHY_2M)
+    {
+        Conn_Params_Requested(&conn->link, CONN_PARAMS_PENDING_PHY,
+                              ble_gap_set_prefered_le_phy(conn->conn_handle, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_CODED_ANY));
+    }
+
+    conn->link.throughput_bps = Conn_Params_Budget(&conn->link, conn->mtu); /* Budget with what is known so far */
+}
+
+/**
+ * @brief BLE GAP event handler
+ *
+ * This function handles various GAP events such as connection, disconnection,
+ * advertising complete, and subscription. It logs the events and performs
+ * appropriate actions based on the event type.
+ *
+ * Runs in the NimBLE host task, so its records go to the DEFERRED_LOG_HOST
+ * channel registered by Host_task. BLE_GAP_EVENT_NOTIFY_TX is deliberately
+ * left to the default case and not logged: the host raises it for every
+ * notification sent, so at sensor stream rates a record per event would
+ * fill the log ring and crowd out the events above. Notifications are
+ * counted in the diagnostics counters instead.
+ *
+ * @param event Pointer to the BLE GAP event structure.
+ * @param arg Pointer to user-defined argument.
+ * @return int 0 on success, error code otherwise.
+ */
+int BLE_gap_event(struct ble_gap_event *event, void *arg)
+{
+    int64_t start = esp_timer_get_time(); /* Start of the callback, for the diagnostics */
+    Connection_State *conn;               /* State of the connection the event is about */
+
+    switch (event->type) /* Switch on the type of GAP event */
+    {
+    case BLE_GAP_EVENT_CONNECT:                                     /* Event type: Connection */
+        Deferred_Log(LOG_GAP_CONNECT, event->connect.status, 0, 0); /* Log the connection event status */
+        if (event->connect.status != 0)                             /* If the connection failed */
+        {
+            BLE_app_advertise(); /* Restart advertising */
+            break;
+        }
+        if (Adv_Sched_On_Connect(&Adv_Scheduler, BLE_app_now_ms())) /* End the fast burst and measure the reconnect */
+        {
+            Deferred_Log(LOG_GAP_RECONNECT, Adv_Scheduler.reconnect.last_ms, 0, 0);
+            Diag_Record_Reconnect(Adv_Scheduler.reconnect.last_ms); /* Expose the latency through the diagnostics */
+        }
+        conn = Conn_Table_Add(event->connect.conn_handle); /* Claim a slot for the connection */
+        if (conn == NULL) /* No slot left: the connection would get no state, so refuse it */
+        {
+            Deferred_Log(LOG_GAP_TABLE_FULL, event->connect.conn_handle, 0, 0);
+            ble_gap_terminate(event->connect.conn_handle, BLE_ERR_CONN_LIMIT);
+        }
+        else
+        {
+            BLE_app_negotiate(conn); /* Ask for the link parameters of the profile */
+        }
+        if (Conn_Table_Count() < CONN_TABLE_SIZE) /* Keep advertising while slots remain */
+        {
+            BLE_app_advertise();
+        }
+        break;
+
+    case BLE_GAP_EVENT_DISCONNECT:                                        /* Event type: Disconnection */
+        Deferred_Log(LOG_GAP_DISCONNECT, event->disconnect.reason, 0, 0); /* Log the disconnection event */
+        if (Conn_Table_Find(event->disconnect.conn.conn_handle) == NULL)  /* Refused with the table full, no slot was freed */
+        {
+            break;
+        }
+        Conn_Table_Remove(event->disconnect.conn.conn_handle);            /* Release the slot of the connection */
+        Gatt_Svr_Connection_Closed();                                     /* Stop the timers nobody needs any more */
+        Adv_Sched_On_Disconnect(&Adv_Scheduler, BLE_app_now_ms());        /* Open a fast advertising burst */
+        BLE_app_advertise();                                              /* Restart advertising */
+        break;
+
+    case BLE_GAP_EVENT_ADV_COMPLETE:                 /* Event type: Advertising complete */
+        Deferred_Log(LOG_GAP_ADV_COMPLETE, 0, 0, 0); /* Log the advertising complete event */
+        BLE_app_advertise();                         /* Restart advertising */
+        break;
+
+    case BLE_GAP_EVENT_SUBSCRIBE:                                                                      /* Event type: Subscription */
+        Deferred_Log(LOG_GAP_SUBSCRIBE, event->subscribe.attr_handle, event->subscribe.cur_notify, 0); /* Log the subscribe event */
+        Gatt_Svr_Subscribe(event);                                                                     /* Record the subscription and start the matching timer */
+        break;
+
+    case BLE_GAP_EVENT_MTU:                                           /* Event type: MTU exchanged */
+        Deferred_Log(LOG_GAP_MTU, event->mtu.value, 0, 0);            /* Log the negotiated MTU */
+        Conn_Table_Set_MTU(event->mtu.conn_handle, event->mtu.value); /* Save the MTU for this connection */
+        break;
+
+    case BLE_GAP_EVENT_CONN_UPDATE:                             /* Event type: Connection parameters updated */
+        conn = Conn_Table_Find(event->conn_update.conn_handle); /* Look up the state of this connection */
+        if (conn != NULL)
+        {
+            BLE_app_link_refresh(conn, event->conn_update.status); /* Record what the central accepted */
+            Deferred_Log(LOG_GAP_CONN_UPDATE, event->conn_update.status, conn->link.itvl, conn->link.throughput_bps);
+        }
+        break;
+
+    case BLE_GAP_EVENT_PHY_UPDATE_COMPLETE:                     /* Event type: PHY updated */
+        conn = Conn_Table_Find(event->phy_updated.conn_handle); /* Look up the state of this connection */
+        if (conn != NULL)
+        {
+            Conn_Params_On_Phy_Update(&conn->link, event->phy_updated.status, event->phy_updated.tx_phy, event->phy_updated.rx_phy);
+            conn->link.throughput_bps = Conn_Params_Budget(&conn->link, conn->mtu); /* A faster PHY raises the budget */
+            Deferred_Log(LOG_GAP_PHY_UPDATE, conn->link.tx_phy, conn->link.rx_phy, 0);
+        }
+        break;
+
+    default: /* Default case for unhandled events */
+        break;
+    }
+
+    Diag_Record_Callback_Time((uint32_t)(esp_timer_get_time() - start)); /* Record how long the event took */
+    return 0;                                                            /* Return success */
+}
+
+/**
+ * @brief Encode the advertising and scan response payloads
+ *
+ * The advertising payload carries the flags, TX power level and device name;
+ * the scan response carries the custom service UUID. Both are encoded once
+ * into static buffers and handed to the controller, which keeps them across
+ * every later advertising restart.
+ *
+ * @return int 0 on success, NimBLE error code otherwise
+ */
+static int BLE_app_set_adv_data(void)
+{
+    struct ble_hs_adv_fields fields;    /* Declare advertising fields */
+    memset(&fields, 0, sizeof(fields)); /* Clear the advertising fields structure */
+
+    fields.flags = BLE_HS_ADV_F_DISC_GEN | BLE_HS_ADV_F_DISC_LTD; /* Set the advertising flags for general and limited discoverability */
+    fields.tx_pwr_lvl_is_present = true;                          /* Indicate that the TX power level is present */
+    fields.tx_pwr_lvl = BLE_HS_ADV_TX_PWR_LVL_AUTO;               /* Set the TX power level to auto */
+
+    fields.name = (uint8_t *)DEVICE_NAME;      /* Set the device name for advertising, the same string given to the GAP service */
+    fields.name_len = sizeof(DEVICE_NAME) - 1; /* Set the length of the device name, known at compile time */
+    fields.name_is_complete = true;            /* Indicate that the device name is complete */
+
+    int rc = ble_hs_adv_set_fields(&fields, Adv_Data, &Adv_Data_Len, sizeof(Adv_Data)); /* Encode the advertising payload */
+    if (rc != 0)
+    {
+        return rc;
+    }
+
+    memset(&fields, 0, sizeof(fields));     /* Clear the fields for the scan response */
+    fields.uuids128 = &Custom_Service_UUID; /* Advertise the custom service */
+    fields.num_uuids128 = 1;
+    fields.uuids128_is_complete = true;
+
+    rc = ble_hs_adv_set_fields(&fields, Scan_Rsp_Data, &Scan_Rsp_Data_Len, sizeof(Scan_Rsp_Data)); /* Encode the scan response payload */
+    if (rc != 0)
+    {
+        return rc;
+    }
+
+    rc = ble_gap_adv_set_data(Adv_Data, Adv_Data_Len); /* Hand the advertising payload to the controller */
+    if (rc != 0)
+    {
+        return rc;
+    }
+    return ble_gap_adv_rsp_set_data(Scan_Rsp_Data, Scan_Rsp_Data_Len); /* Hand the scan response payload to the controller */
+}
+
+/**
+ * @brief Start BLE advertising
+ *
+ * This function starts advertising with the payloads set up by
+ * BLE_app_set_adv_data and the intervals chosen by the advertising
+ * scheduler: a fast interval for a limited burst after boot or a disconnect,
+ * then a slow, power saving interval. When a fast burst runs out the
+ * BLE_GAP_EVENT_ADV_COMPLETE event brings the device back here to switch to
+ * the slow interval.
+ */
+void BLE_app_advertise(void)
+{
+    Adv_Sched_Params sched;                                   /* Intervals and duration for this run */
+    Adv_Sched_Next(&Adv_Scheduler, BLE_app_now_ms(), &sched); /* Ask the scheduler what to do next */
+
+    struct ble_gap_adv_params adv_params;                         /* Declare advertising parameters */
+    memset(&adv_params, 0, sizeof(adv_params));                   /* Clear the advertising parameters structure */
+    adv_params.conn_mode = BLE_GAP_CONN_MODE_UND;                 /* Set the connection mode to undirected */
+    adv_params.disc_mode = BLE_GAP_DISC_MODE_GEN;                 /* Set the discovery mode to general */
+    adv_params.itvl_min = BLE_GAP_ADV_ITVL_MS(sched.itvl_min_ms); /* Set the minimum advertising interval */
+    adv_params.itvl_max = BLE_GAP_ADV_ITVL_MS(sched.itvl_max_ms); /* Set the maximum advertising interval */
+
+    if (ble_gap_adv_active()) /* Advertising for a further slot, restart it with the new intervals */
+    {
+        ble_gap_adv_stop();
+    }
+
+    ble_gap_adv_start(BLE_Addr_Type, NULL, sched.duration_ms == ADV_SCHED_FOREVER ? BLE_HS_FOREVER : (int32_t)sched.duration_ms,
+                      &adv_params, BLE_gap_event, NULL); /* Start advertising */
+}
+
+/**
+ * @brief BLE synchronization callback
+ *
+ * This function is called when the BLE stack has completed synchronization.
+ * It infers the BLE address type automatically, sets up the advertising
+ * payloads and starts the advertising process.
+ */
+void BLE_app_on_sync(void)
+{
+    ble_hs_id_infer_auto(0, &BLE_Addr_Type); /* Infer the BLE address type automatically */
+
+    int rc = BLE_app_set_adv_data(); /* Encode and set the advertising payloads */
+    if (rc != 0)
+    {
+        ESP_LOGE("GAP", "Setting advertising data failed: %d", rc);
+        return;
+    }
+
+    BLE_app_advertise(); /* Start advertising */
+}
+
+/**
+ * @brief Reset the advertising scheduler
+ *
+ * Must be called before the NimBLE host starts, so the first advertising run
+ * after sync is a fast burst.
+ */
+void Gap_Svr_Init(void)
+{
+    Adv_Sched_Init(&Adv_Scheduler, BLE_app_now_ms()); /* Start with a fast advertising burst */
+}
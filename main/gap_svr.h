@@ -0,0 +1,21 @@
+/* BLE GATT example - GAP event handling and advertising
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef GAP_SVR_H
+#define GAP_SVR_H
+
+#include <host/ble_hs.h> /* This is ESP lib used for the GAP event type */
+
+#define DEVICE_NAME "HARTMAN_SIGHT" /* Define the device name */
+
+void Gap_Svr_Init(void);
+int BLE_gap_event(struct ble_gap_event *event, void *arg);
+void BLE_app_advertise(void);
+void BLE_app_on_sync(void);
+
+#endif /* GAP_SVR_H */
@@ -0,0 +1,776 @@
+/* BLE GATT example - GATT services
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <stdio.h>                       /* This is the standard C lib used for the printf statement */
+#include <esp_timer.h>                   /* This is ESP lib used to time the callbacks */
+#include <nimble/nimble_port.h>          /* This is ESP lib used for the default event queue of the host task */
+#include <nimble/nimble_port_freertos.h> /* This is ESP lib used for the FreeRTOS timers */
+#include <host/ble_hs.h>                 /* This is ESP lib used for the ble host controller */
+#include "gatt_svr.h"                    /* This is the GATT services interface */
+#include "conn_table.h"                  /* This is the per-connection state table */
+#include "notify_pool.h"                 /* This is the dedicated notification buffer pool */
+#include "sensor_stream.h"               /* This is the batched sensor streaming */
+#include "ingest.h"                      /* This is the write ingest pipeline */
+#include "diag.h"                        /* This is the runtime performance counters */
+#include "value_pub.h"                   /* This is the change driven value publishing */
+#include "deferred_log.h"                /* This is the deferred logging */
+
+#define DEVICE_INFO_SERVICE 0x180A              /* Define the device information service UUID */
+#define MANUFACTURER_NAME 0x2A29                /* Define the manufacturer name characteristic UUID */
+#define DEVICE_BATTERY_SERVICE 0x180F           /* Define the device battery service UUID */
+#define BATTERY_LEVEL 0x2A19                    /* Define the battery level characteristic UUID */
+#define BATTERY_CLIENT_CONFIG_DESCRIPTOR 0x2902 /* Define the battery client configuration descriptor UUID */
+#define BATTERY_INFORMATION 0x2BEC              /* Define the battery information characteristic UUID */
+#define SENSOR_SAMPLE_PERIOD_MS 10              /* Define the sensor sampling period */
+#define SENSOR_STREAM_DEADLINE_MS 100           /* Define the maximum time a sample waits before its frame is sent */
+#define BATTERY_NOTIFY_HYSTERESIS 2             /* Define the change in battery level needed before subscribers are notified again */
+#define DIAGNOSTICS_READ_TIMEOUT_MS 1000        /* Define the time after which an unfinished long read of the diagnostics starts over */
+
+uint16_t Battery_level_characteristic_attribute_handler; /* Variable to hold the battery level characteristic attribute handler */
+uint16_t Sensor_Stream_characteristic_attribute_handler; /* Variable to hold the sensor stream characteristic attribute handler */
+uint16_t Diagnostics_characteristic_attribute_handler;   /* Variable to hold the diagnostics characteristic attribute handler */
+static xTimerHandle Battery_Timer_Handler;               /* Timer handler for the battery level update, shared by all connections */
+static xTimerHandle Battery_Flush_Timer_Handler;         /* One shot timer sending battery notifications held back by coalescing */
+static xTimerHandle Sensor_Timer_Handler;                /* Timer handler for the sensor sampling, shared by all connections */
+static struct ble_npl_event Battery_Update_Event;        /* Battery update posted to the host task by Battery_Timer_Handler */
+static struct ble_npl_event Battery_Flush_Event;         /* Battery flush posted to the host task by Battery_Flush_Timer_Handler */
+static struct ble_npl_event Sensor_Sample_Event;         /* Sensor sample posted to the host task by Sensor_Timer_Handler */
+static Sensor_Stream Sensor_Stream_Batcher;              /* Coalesces sensor samples into MTU sized frames */
+static uint16_t Sensor_Sample_Value;                     /* Synthetic sensor reading */
+
+static Value_Pub Battery_Publisher; /* Cached battery level and its notification policy */
+
+/**
+ * @brief Diagnostics snapshot kept for the long read of one connection
+ */
+typedef struct
+{
+    uint8_t data[DIAG_SNAPSHOT_MAX_SIZE]; /* Snapshot taken when the read started */
+    uint16_t len;                         /* Length of the snapshot */
+} Diagnostics_Snapshot;
+
+static Diagnostics_Snapshot Diagnostics_Read_Cache[CONN_TABLE_SIZE]; /* One per connection slot, see Conn_Table_Index */
+
+/**
+ * @brief Send one notification from the notification pool
+ *
+ * Shared by every notifying characteristic so that each notification is
+ * counted the same way in the diagnostics counters.
+ *
+ * @param conn Connection to notify
+ * @param attr_handle Value handle of the characteristic
+ * @param data Value to send
+ * @param len Length of the value
+ * @return true if the notification was handed to the host
+ */
+static bool Gatt_Svr_Notify(Connection_State *conn, uint16_t attr_handle, const void *data, uint16_t len)
+{
+    struct os_mbuf *om = Notify_Pool_Get(data, len); /* Copy the value into a notification buffer */
+
+    if (om == NULL) /* Pool exhausted, the caller backs off */
+    {
+        Diag_Count(DIAG_MBUF_ALLOC_FAILED);
+        Diag_Count(DIAG_NOTIFY_FAILED);
+        return false;
+    }
+
+    if (ble_gattc_notify_custom(conn->conn_handle, attr_handle, om) != 0) /* Notify the client, the buffer is consumed either way */
+    {
+        Diag_Count(DIAG_NOTIFY_FAILED);
+        return false;
+    }
+
+    Diag_Count(DIAG_NOTIFY_SENT);
+    conn->bytes_out += len;
+    return true;
+}
+
+/**
+ * @brief Start or stop the battery timer to match the subscriptions
+ *
+ * The battery timer is a single scheduler tick shared by every connection.
+ * It runs while at least one connection has notifications enabled and is
+ * stopped once the last subscriber unsubscribes or disconnects.
+ */
+static void Battery_Timer_Refresh(void)
+{
+    if (Conn_Table_Subscribed_Count() > 0) /* At least one central wants notifications */
+    {
+        if (xTimerIsTimerActive(Battery_Timer_Handler) == pdFALSE) /* Do not restart a running timer */
+        {
+            xTimerStart(Battery_Timer_Handler, 0); /* Start the battery timer */
+        }
+    }
+    else /* Nobody is subscribed */
+    {
+        xTimerStop(Battery_Timer_Handler, 0); /* Stop the battery timer */
+    }
+}
+
+/**
+ * @brief GATT descriptor access callback for battery level notifications
+ *
+ * This function handles read and write operations to the battery level
+ * Client Characteristic Configuration Descriptor (CCCD). The value is kept
+ * per connection in the connection table (bit 0 enables notifications) and
+ * the shared battery timer is started or stopped accordingly.
+ * @link https://www.bluetooth.com/wp-content/uploads/Sitecore-Media-Library/Gatt/Xml/Descriptors/org.bluetooth.descriptor.gatt.client_characteristic_configuration.xml
+ *
+ * @param conn_handle Connection handle
+ * @param attr_handle Attribute handle
+ * @param ctxt GATT access context
+ * @param arg User-defined argument
+ * @return int Returns 0 on success, ATT error code otherwise
+ */
+int Battery_Level_Descriptor(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+    Connection_State *conn = Conn_Table_Find(conn_handle); /* Look up the state of this connection */
+    uint8_t config[2];                                     /* CCCD value in little endian order */
+
+    if (conn == NULL) /* Connection is not tracked */
+    {
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    if (ctxt->op == BLE_GATT_ACCESS_OP_READ_DSC) /* Check if the operation is a read descriptor */
+    {
+        config[0] = conn->battery_cccd & 0xFF;             /* Low byte of the configuration */
+        config[1] = conn->battery_cccd >> 8;               /* High byte of the configuration */
+        os_mbuf_append(ctxt->om, config, sizeof(config)); /* Append the configuration to the output buffer */
+        return 0;                                          /* Reading does not change the subscription */
+    }
+
+    /* If the operation is not read, it must be write */
+    if (OS_MBUF_PKTLEN(ctxt->om) != sizeof(config)) /* A CCCD value is always two bytes */
+    {
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+    }
+    ble_hs_mbuf_to_flat(ctxt->om, config, sizeof(config), NULL);                /* Copy the configuration from the input buffer */
+    Conn_Table_Set_Battery_CCCD(conn_handle, config[0] | (config[1] << 8)); /* Save the configuration for this connection */
+
+    Battery_Timer_Refresh(); /* Start or stop the battery timer */
+    return 0;                /* Return success */
+}
+
+/**
+ * @brief Summary of the connections subscribed to the sensor stream
+ */
+typedef struct
+{
+    size_t subscribers; /* Connections with stream notifications enabled */
+    uint16_t min_mtu;   /* Smallest ATT MTU among them */
+} Sensor_Stream_Subscribers;
+
+/**
+ * @brief Add one connection to the sensor stream subscriber summary
+ *
+ * @param conn Connection being visited
+ * @param arg Pointer to the Sensor_Stream_Subscribers being filled
+ */
+static void Sensor_Stream_Count_Connection(Connection_State *conn, void *arg)
+{
+    Sensor_Stream_Subscribers *summary = arg;
+
+    if (!conn->stream_notify) /* Not streaming to this connection */
+    {
+        return;
+    }
+
+    if (summary->subscribers == 0 || conn->mtu < summary->min_mtu) /* Frames must fit the smallest MTU */
+    {
+        summary->min_mtu = conn->mtu;
+    }
+    summary->subscribers++;
+}
+
+/**
+ * @brief Frame handed from the batcher to the subscribers
+ */
+typedef struct
+{
+    const uint8_t *data; /* Sequence number followed by the samples */
+    uint16_t len;        /* Length of the frame */
+    uint32_t now_ms;     /* Time the frame is sent, for the link budgets */
+} Sensor_Stream_Frame;
+
+/**
+ * @brief Send one frame to a sensor stream subscriber
+ *
+ * Frames are charged to the connection's link budget (see
+ * Conn_Params_Budget_Take), so a slow link skips frames instead of filling
+ * the notification pool that every connection shares.
+ *
+ * @param conn Connection being visited
+ * @param arg Pointer to the frame being sent
+ */
+static void Sensor_Stream_Notify_Connection(Connection_State *conn, void *arg)
+{
+    const Sensor_Stream_Frame *frame = arg;
+
+    if (!conn->stream_notify) /* Not streaming to this connection */
+    {
+        return;
+    }
+
+    if (!Conn_Params_Budget_Take(&conn->link, frame->now_ms, frame->len)) /* The link cannot carry it, skip a frame rather than queue */
+    {
+        Diag_Count(DIAG_STREAM_OVER_BUDGET);
+        return;
+    }
+
+    Gatt_Svr_Notify(conn, Sensor_Stream_characteristic_attribute_handler, frame->data, frame->len); /* On failure the client sees a gap in the sequence numbers */
+}
+
+/**
+ * @brief Flush callback of the sensor stream batcher
+ *
+ * @param frame Completed frame
+ * @param len Length of the frame
+ * @param arg User-defined argument (unused)
+ */
+static void Sensor_Stream_Send(const uint8_t *frame, uint16_t len, void *arg)
+{
+    Sensor_Stream_Frame out = {frame, len, xTaskGetTickCount() * portTICK_PERIOD_MS};
+
+    Conn_Table_For_Each(Sensor_Stream_Notify_Connection, &out); /* Fan the frame out to every subscriber */
+}
+
+/**
+ * @brief Sample the sensor, in the host task
+ *
+ * Posted every SENSOR_SAMPLE_PERIOD_MS by Sensor_Sample_Timer while at least
+ * one connection is subscribed to the sensor stream. Each sample is queued in
+ * the batcher, which sends a frame once it reaches MTU-3 bytes or once its
+ * oldest sample is SENSOR_STREAM_DEADLINE_MS old. The timer is stopped when
+ * the last subscriber goes away.
+ *
+ * @param ev Sensor_Sample_Event
+ */
+static void Sensor_Sample(struct ble_npl_event *ev)
+{
+    int64_t start = esp_timer_get_time(); /* Start of the callback, for the diagnostics */
+    Sensor_Stream_Subscribers summary = {0};
+    TickType_t now = xTaskGetTickCount(); /* Timestamp of this sample */
+
+    Conn_Table_For_Each(Sensor_Stream_Count_Connection, &summary); /* Find the subscribers and their smallest MTU */
+
+    if (summary.subscribers == 0) /* Nobody is listening any more */
+    {
+        Sensor_Stream_Discard(&Sensor_Stream_Batcher); /* Drop samples nobody will receive */
+        xTimerStop(Sensor_Timer_Handler, 0);           /* Stop sampling */
+        return;
+    }
+
+    Sensor_Stream_Set_MTU(&Sensor_Stream_Batcher, summary.min_mtu); /* Size frames for the smallest MTU */
+
+    Sensor_Sample_Value += 7; /* Simulate a new sensor reading */
+    uint8_t sample[2] = {Sensor_Sample_Value & 0xFF, Sensor_Sample_Value >> 8};
+
+    Sensor_Stream_Push(&Sensor_Stream_Batcher, sample, sizeof(sample), now); /* Queue the sample, sending a full frame */
+    Sensor_Stream_Poll(&Sensor_Stream_Batcher, now);                        /* Send the frame if its deadline passed */
+
+    Diag_Record_Callback_Time((uint32_t)(esp_timer_get_time() - start)); /* Record how long sampling took */
+}
+
+/**
+ * @brief Timer callback function to sample the sensor
+ *
+ * Runs in the timer task, so it only hands the work to the host task.
+ */
+static void Sensor_Sample_Timer(TimerHandle_t timer)
+{
+    ble_npl_eventq_put(nimble_port_get_dflt_eventq(), &Sensor_Sample_Event); /* Ignored while the previous sample is still queued */
+}
+
+/**
+ * @brief GATT access callback for the sensor stream characteristic
+ *
+ * The characteristic is notify-only; its data is only ever pushed by
+ * Sensor_Sample.
+ *
+ * @return int Always an ATT error, the value cannot be accessed directly
+ */
+int Sensor_Stream_Characteristic(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+    return BLE_ATT_ERR_UNLIKELY;
+}
+
+/**
+ * @brief GATT access callback for the custom characteristic
+ *
+ * Runs in the NimBLE host task, so it only queues the written value for the
+ * ingest worker on core 1 and returns. Both Write Request and Write Without
+ * Response end up here, as do long writes once the host has executed the
+ * queued prepare writes.
+ *
+ * @param conn_handle Connection handle
+ * @param attr_handle Attribute handle
+ * @param ctxt GATT access context
+ * @param arg User-defined argument
+ * @return int Returns 0 on success, ATT error code if the value was not accepted
+ */
+int Custom_Service(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+    int64_t start = esp_timer_get_time();                  /* Start of the callback, for the diagnostics */
+    Connection_State *conn = Conn_Table_Find(conn_handle); /* Look up the state of this connection */
+    int rc = 0;
+
+    Diag_Count(DIAG_WRITE_RECEIVED);
+    if (Ingest_Submit(ctxt->om) != 0) /* Queue the incoming message for the worker */
+    {
+        Diag_Count(DIAG_WRITE_DROPPED);
+        rc = BLE_ATT_ERR_INSUFFICIENT_RES; /* Ring full or message too long */
+    }
+    else if (conn != NULL)
+    {
+        conn->bytes_in += OS_MBUF_PKTLEN(ctxt->om); /* Count the accepted bytes against the connection */
+    }
+
+    Diag_Record_Callback_Time((uint32_t)(esp_timer_get_time() - start)); /* Record how long the write took */
+    return rc;
+}
+
+/**
+ * @brief Ingest handler for the messages written to the custom characteristic
+ *
+ * Given to Ingest_Init, so it runs in the ingest worker task rather than in
+ * the NimBLE host task.
+ *
+ * @param data Message written by the client
+ * @param len Length of the message
+ * @param arg Argument given to Ingest_Init (unused)
+ */
+void Custom_Message_Received(const uint8_t *data, size_t len, void *arg)
+{
+    printf("Incoming Message :- %.*s \n", (int)len, (const char *)data); /* Print the incoming message */
+}
+
+/**
+ * @brief GATT access callback for the diagnostics characteristic
+ *
+ * Returns the binary snapshot built by Diag_Snapshot (layout in diag.c).
+ * Clients with a small MTU get the rest through Read Blob requests, for
+ * each of which the host calls back and sends the part at the requested
+ * offset. The snapshot taken for the first request is kept for the
+ * connection and served again until the last part, one shorter than the
+ * MTU allows, has been read, so that the parts fit together and the
+ * counters are only serialised once per read. A read left unfinished for
+ * DIAGNOSTICS_READ_TIMEOUT_MS starts over with a new snapshot.
+ *
+ * @param conn_handle Connection handle
+ * @param attr_handle Attribute handle
+ * @param ctxt GATT access context
+ * @param arg User-defined argument
+ * @return int Returns 0 on success, ATT error code if the snapshot did not fit
+ */
+int Diagnostics_Characteristic(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+    Connection_State *conn = Conn_Table_Find(conn_handle);      /* Look up the state of this connection */
+    uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS; /* Time of this request */
+    Diagnostics_Snapshot fresh;                                 /* Snapshot for a connection that is not tracked */
+    Diagnostics_Snapshot *snapshot = &fresh;                    /* Snapshot served by this request */
+
+    if (conn != NULL)
+    {
+        snapshot = &Diagnostics_Read_Cache[Conn_Table_Index(conn)];
+        if (conn->diag_served != 0 && now_ms - conn->diag_read_ms >= DIAGNOSTICS_READ_TIMEOUT_MS) /* Long read abandoned */
+        {
+            conn->diag_served = 0;
+        }
+    }
+
+    if (conn == NULL || conn->diag_served == 0) /* First part of a read: serialise the counters */
+    {
+        snapshot->len = Diag_Snapshot(snapshot->data, sizeof(snapshot->data));
+    }
+
+    if (os_mbuf_append(ctxt->om, snapshot->data, snapshot->len) != 0) /* Append the snapshot to the output buffer */
+    {
+        return BLE_ATT_ERR_INSUFFICIENT_RES;
+    }
+
+    if (conn != NULL)
+    {
+        uint16_t part = conn->mtu - 1;                      /* Value bytes in a Read or Read Blob response */
+        uint16_t chunk = snapshot->len - conn->diag_served; /* Bytes left for this and later requests */
+
+        if (chunk > part)
+        {
+            chunk = part;
+        }
+        conn->diag_served = chunk < part ? 0 : conn->diag_served + chunk; /* A short part ends the read */
+        conn->diag_read_ms = now_ms;
+    }
+    return 0; /* Return success */
+}
+
+/**
+ * @brief GATT access callback for the battery level characteristic
+ *
+ * Serves the cached level, the same value subscribers are notified with.
+ *
+ * @param conn_handle Connection handle
+ * @param attr_handle Attribute handle
+ * @param ctxt GATT access context
+ * @param arg User-defined argument
+ * @return int Returns 0 on success
+ */
+int Device_Battery_Level(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+    const uint8_t message = Value_Pub_Get(&Battery_Publisher); /* Battery level message */
+    os_mbuf_append(ctxt->om, &message, sizeof(message));       /* Append the message to the output buffer */
+    return 0;                                                  /* Return success */
+}
+
+/**
+ * @brief Constant characteristic values
+ *
+ * Every read-only characteristic whose value never changes is listed here
+ * once, as X(index, value). The list expands into the Static_Values table,
+ * with each length computed by the compiler, and GATT_Service points the
+ * characteristic at its entry through the access callback argument. Adding a
+ * constant characteristic only needs a new line here and in GATT_Service.
+ */
+#define STATIC_VALUE_LIST(X)                                \
+    X(STATIC_VALUE_MANUFACTURER_NAME, "PARAS DEFENSE")      \
+    X(STATIC_VALUE_BATTERY_INFORMATION, "NOT CONNECTED")
+
+#define STATIC_VALUE_INDEX(index, value) index,
+#define STATIC_VALUE_ENTRY(index, value) [index] = {(const uint8_t *)(value), sizeof(value) - 1},
+
+enum
+{
+    STATIC_VALUE_LIST(STATIC_VALUE_INDEX)
+    STATIC_VALUE_COUNT /* Number of constant characteristic values */
+};
+
+/**
+ * @brief Preformatted value of a constant characteristic
+ */
+typedef struct
+{
+    const uint8_t *data; /* Value bytes, without any terminator */
+    uint16_t len;        /* Length of the value */
+} Static_Value;
+
+static const Static_Value Static_Values[STATIC_VALUE_COUNT] = {STATIC_VALUE_LIST(STATIC_VALUE_ENTRY)}; /* Constant values and their lengths */
+
+/**
+ * @brief GATT access callback shared by every constant characteristic
+ *
+ * The characteristic's entry in Static_Values is passed as the access
+ * callback argument, so a read is a single append of preformatted bytes.
+ *
+ * @param conn_handle Connection handle
+ * @param attr_handle Attribute handle
+ * @param ctxt GATT access context
+ * @param arg Pointer to the Static_Value to return
+ * @return int Returns 0 on success, ATT error code if the value did not fit
+ */
+int Static_Value_Read(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+    const Static_Value *value = arg;
+
+    if (os_mbuf_append(ctxt->om, value->data, value->len) != 0) /* Append the value to the output buffer */
+    {
+        return BLE_ATT_ERR_INSUFFICIENT_RES;
+    }
+    return 0; /* Return success */
+}
+
+/**
+ * @brief GATT service definitions
+ *
+ * This array defines the GATT services and characteristics for the BLE application.
+ * It includes the Device Information Service, Battery Service, and a Custom Service.
+ *
+ * - Device Information Service:
+ *   - Characteristic: Manufacturer Name (Read-only)
+ *
+ * - Battery Service:
+ *   - Characteristic: Battery Information (Read-only)
+ *   - Characteristic: Battery Level (Read and Notify)
+ *     - Descriptor: Client Configuration (Read and Write)
+ *
+ * - Custom Service:
+ *   - Characteristic: Custom Characteristic (Write and Write Without Response)
+ *   - Characteristic: Sensor Stream (Notify-only, batched samples behind a sequence number)
+ *   - Characteristic: Diagnostics (Read-only, binary snapshot of the performance counters)
+ *
+ * The services are defined as primary services. Each characteristic within a service
+ * has a UUID, flags indicating its properties (e.g., read, write, notify), and an
+ * access callback function to handle read/write operations.
+ */
+const struct ble_gatt_svc_def GATT_Service[] =
+    {
+        {.type = BLE_GATT_SVC_TYPE_PRIMARY,               /* Primary service */
+         .uuid = BLE_UUID16_DECLARE(DEVICE_INFO_SERVICE), /* Device information service UUID */
+         .characteristics = (struct ble_gatt_chr_def[]){{
+                                                            .uuid = BLE_UUID16_DECLARE(MANUFACTURER_NAME), /* Manufacturer name characteristic UUID */
+                                                            .flags = BLE_GATT_CHR_F_READ,                  /* Read flag */
+                                                            .access_cb = Static_Value_Read,                /* Access callback for constant values */
+                                                            .arg = (void *)&Static_Values[STATIC_VALUE_MANUFACTURER_NAME] /* Manufacturer name value */
+                                                        },
+                                                        {0}}},
+
+        {.type = BLE_GATT_SVC_TYPE_PRIMARY,                  /* Primary service */
+         .uuid = BLE_UUID16_DECLARE(DEVICE_BATTERY_SERVICE), /* Battery service UUID */
+         .characteristics = (struct ble_gatt_chr_def[]){{
+                                                            .uuid = BLE_UUID16_DECLARE(BATTERY_INFORMATION), /* Battery information characteristic UUID */
+                                                            .flags = BLE_GATT_CHR_F_READ,                    /* Read flag */
+                                                            .access_cb = Static_Value_Read,                  /* Access callback for constant values */
+                                                            .arg = (void *)&Static_Values[STATIC_VALUE_BATTERY_INFORMATION] /* Battery information value */
+                                                        },
+                                                        {.uuid = BLE_UUID16_DECLARE(BATTERY_LEVEL),                     /* Battery level characteristic UUID */
+                                                         .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,          /* Read and notify flags */
+                                                         .access_cb = Device_Battery_Level,                             /* Access callback for battery level */
+                                                         .val_handle = &Battery_level_characteristic_attribute_handler, /* Handle for the battery level characteristic */
+                                                         .descriptors = (struct ble_gatt_dsc_def[]){{
+                                                                                                        .uuid = BLE_UUID16_DECLARE(BATTERY_CLIENT_CONFIG_DESCRIPTOR), /* Client configuration descriptor UUID */
+                                                                                                        .att_flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_WRITE,      /* Read and write flags */
+                                                                                                        .access_cb = Battery_Level_Descriptor                         /* Access callback for battery level descriptor */
+                                                                                                    },
+                                                                                                    {0}}},
+                                                        {0}}},
+
+        {.type = BLE_GATT_SVC_TYPE_PRIMARY,                                                                                           /* Primary service */
+         .uuid = BLE_UUID128_DECLARE(0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff), /* Custom service UUID */
+         .characteristics = (struct ble_gatt_chr_def[]){{
+                                                            .uuid = BLE_UUID128_DECLARE(0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00), /* Custom characteristic UUID */
+                                                            .flags = BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_WRITE_NO_RSP,                                                                 /* Write and write without response flags */
+                                                            .access_cb = Custom_Service                                                                                                  /* Access callback for custom service */
+                                                        },
+                                                        {.uuid = BLE_UUID128_DECLARE(0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x01), /* Sensor stream characteristic UUID */
+                                                         .flags = BLE_GATT_CHR_F_NOTIFY,                                                                                               /* Notify flag */
+                                                         .access_cb = Sensor_Stream_Characteristic,                                                                                    /* Access callback for sensor stream */
+                                                         .val_handle = &Sensor_Stream_characteristic_attribute_handler                                                                 /* Handle for the sensor stream characteristic */
+                                                        },
+                                                        {.uuid = BLE_UUID128_DECLARE(0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x02), /* Diagnostics characteristic UUID */
+                                                         .flags = BLE_GATT_CHR_F_READ,                                                                                                 /* Read flag */
+                                                         .access_cb = Diagnostics_Characteristic,                                                                                      /* Access callback for diagnostics */
+                                                         .val_handle = &Diagnostics_characteristic_attribute_handler                                                                   /* Handle for the diagnostics characteristic */
+                                                        },
+                                                        {0}}},
+        {0}};
+
+/**
+ * @brief State of one pass over the battery subscribers
+ */
+typedef struct
+{
+    uint32_t now;  /* Tick of the pass */
+    uint32_t wait; /* Shortest wait before a held back notification is due, VALUE_PUB_IDLE if none */
+} Battery_Publish_Pass;
+
+/**
+ * @brief Minimum gap between two battery notifications to one connection
+ *
+ * One connection interval rounded up to whole ticks: anything sent faster
+ * would only queue up in the controller for the same connection event.
+ *
+ * @param conn Connection to notify
+ * @return uint32_t Gap in ticks, at least one
+ */
+static uint32_t Battery_Min_Gap(const Connection_State *conn)
+{
+    uint32_t gap = ((uint32_t)conn->link.itvl * 5 * configTICK_RATE_HZ + 3999) / 4000; /* 1.25 ms units to ticks */
+
+    return gap > 0 ? gap : 1;
+}
+
+/**
+ * @brief Send the battery level to one subscribed connection if it is due
+ *
+ * Visitor used by Battery_Publish for each subscribed connection. The
+ * connection is skipped while the level is within the hysteresis of what it
+ * last received, and held back while its last notification is less than one
+ * connection interval old. The buffer comes from the dedicated notification
+ * pool; if the pool is exhausted the connection is retried one interval later.
+ *
+ * @param conn Connection to notify
+ * @param arg Pointer to the Battery_Publish_Pass being filled
+ */
+static void Battery_Notify_Connection(Connection_State *conn, void *arg)
+{
+    Battery_Publish_Pass *pass = arg;
+    const uint8_t level = Value_Pub_Get(&Battery_Publisher);                                             /* Battery level to send */
+    uint32_t wait = Value_Pub_Due(&Battery_Publisher, &conn->battery, pass->now, Battery_Min_Gap(conn)); /* When this connection is due */
+
+    if (wait == 0) /* Due now */
+    {
+        if (Gatt_Svr_Notify(conn, Battery_level_characteristic_attribute_handler, &level, sizeof(level))) /* Notify the client with the battery level */
+        {
+            Value_Pub_Sent(&Battery_Publisher, &conn->battery, pass->now); /* Remember what this connection last received */
+            return;
+        }
+        wait = Battery_Min_Gap(conn); /* Pool exhausted, try again one interval later */
+    }
+
+    if (wait < pass->wait) /* Keep the earliest deadline */
+    {
+        pass->wait = wait;
+    }
+}
+
+/**
+ * @brief Notify every subscriber the battery level is due for
+ *
+ * Runs in the host task, either after a new level was produced or when the
+ * flush timer fires for notifications held back by coalescing. The flush
+ * timer is re-armed for the earliest connection still waiting.
+ */
+static void Battery_Publish(void)
+{
+    Battery_Publish_Pass pass = {xTaskGetTickCount(), VALUE_PUB_IDLE};
+
+    Conn_Table_For_Each_Subscribed(Battery_Notify_Connection, &pass); /* Fan the notification out to the subscribers that need it */
+
+    if (pass.wait != VALUE_PUB_IDLE) /* Someone was held back */
+    {
+        xTimerChangePeriod(Battery_Flush_Timer_Handler, pass.wait, 0); /* Starts the one shot timer with the new period */
+    }
+}
+
+/**
+ * @brief Send battery notifications held back by coalescing, in the host task
+ *
+ * @param ev Battery_Flush_Event
+ */
+static void Battery_Flush(struct ble_npl_event *ev)
+{
+    int64_t start = esp_timer_get_time(); /* Start of the callback, for the diagnostics */
+
+    Battery_Publish(); /* Send what became due */
+
+    Diag_Record_Callback_Time((uint32_t)(esp_timer_get_time() - start)); /* Record how long the fan out took */
+}
+
+/**
+ * @brief Timer callback sending battery notifications held back by coalescing
+ *
+ * Runs in the timer task, so it only hands the work to the host task.
+ */
+static void Battery_Flush_Timer(TimerHandle_t timer)
+{
+    ble_npl_eventq_put(nimble_port_get_dflt_eventq(), &Battery_Flush_Event);
+}
+
+/**
+ * @brief Update the battery level, in the host task
+ *
+ * This function is posted periodically by Update_Battery_Timer to simulate
+ * the battery level update. It decrements the battery level, resets it to
+ * 100 when it reaches 0, prints the current battery level, and publishes it.
+ * Only the subscribers the change is relevant to are notified, see
+ * Battery_Notify_Connection.
+ *
+ * @param ev Battery_Update_Event
+ */
+static void Update_Battery(struct ble_npl_event *ev)
+{
+    int64_t start = esp_timer_get_time();                  /* Start of the callback, for the diagnostics */
+    uint8_t level = Value_Pub_Get(&Battery_Publisher) - 1; /* Decrement the battery level */
+
+    if (level > 100) /* Reset battery level to 100 once it went below 0 */
+    {
+        level = 100;
+    }
+    Value_Pub_Set(&Battery_Publisher, level); /* Cache the new level for reads */
+
+    Deferred_Log(LOG_BATTERY_LEVEL, level, Battery_Publisher.updates, Battery_Publisher.notified); /* Log the battery level */
+
+    Battery_Publish(); /* Notify the subscribers the change is relevant to */
+
+    Diag_Record_Callback_Time((uint32_t)(esp_timer_get_time() - start)); /* Record how long the fan out took */
+}
+
+/**
+ * @brief Timer callback function to update battery level
+ *
+ * Runs in the timer task, so it only hands the work to the host task.
+ */
+static void Update_Battery_Timer(TimerHandle_t timer)
+{
+    ble_npl_eventq_put(nimble_port_get_dflt_eventq(), &Battery_Update_Event);
+}
+
+/**
+ * @brief Handle a subscription change reported by the GAP event handler
+ *
+ * Records the new notification state for the connection and starts the
+ * matching timer when the first client subscribes.
+ *
+ * @param event BLE_GAP_EVENT_SUBSCRIBE event
+ */
+void Gatt_Svr_Subscribe(const struct ble_gap_event *event)
+{
+    if (event->subscribe.attr_handle == Battery_level_characteristic_attribute_handler) /* Check if the subscription is for the battery level characteristic */
+    {
+        Conn_Table_Set_Battery_CCCD(event->subscribe.conn_handle,
+                                    event->subscribe.cur_notify ? CONN_TABLE_CCCD_NOTIFY : 0); /* Save the subscription for this connection */
+        Battery_Timer_Refresh();                                                             /* Start or stop the battery timer */
+    }
+    else if (event->subscribe.attr_handle == Sensor_Stream_characteristic_attribute_handler) /* Check if the subscription is for the sensor stream */
+    {
+        Conn_Table_Set_Stream_Notify(event->subscribe.conn_handle, event->subscribe.cur_notify); /* Save the subscription for this connection */
+        if (event->subscribe.cur_notify && xTimerIsTimerActive(Sensor_Timer_Handler) == pdFALSE)
+        {
+            xTimerStart(Sensor_Timer_Handler, 0); /* Start sampling, the timer stops itself once nobody listens */
+        }
+    }
+}
+
+/**
+ * @brief Handle a closed connection
+ *
+ * Called once the connection has been removed from the connection table,
+ * so the battery timer stops if nobody is left. The sensor timer notices
+ * on its own.
+ */
+void Gatt_Svr_Connection_Closed(void)
+{
+    Battery_Timer_Refresh(); /* Stop the battery timer if nobody is left */
+}
+
+/**
+ * @brief Register the GATT services and create their timers
+ *
+ * Must be called after ble_svc_gatt_init and before the NimBLE host starts.
+ * The connection table, the battery publisher and the sensor batcher are only
+ * ever touched from the NimBLE host task: the GAP event handler and the access
+ * callbacks run there, and the timers below only post an event to the host's
+ * default event queue, whose handler does the work. No lock is needed, and
+ * none could be held across ble_gattc_notify_custom anyway.
+ *
+ * @return int 0 on success, NimBLE error code otherwise
+ */
+int Gatt_Svr_Init(void)
+{
+    int rc = ble_gatts_count_cfg(GATT_Service); /* Count the GATT services */
+    if (rc != 0)
+    {
+        return rc;
+    }
+
+    rc = ble_gatts_add_svcs(GATT_Service); /* Add the GATT services */
+    if (rc != 0)
+    {
+        return rc;
+    }
+
+    Value_Pub_Init(&Battery_Publisher, 100, BATTERY_NOTIFY_HYSTERESIS);                                                  /* Start from a full battery */
+    ble_npl_event_init(&Battery_Update_Event, Update_Battery, NULL);                                                        /* Work run in the host task for each timer */
+    ble_npl_event_init(&Battery_Flush_Event, Battery_Flush, NULL);
+    ble_npl_event_init(&Sensor_Sample_Event, Sensor_Sample, NULL);
+    Battery_Timer_Handler = xTimerCreate("Update_Battery_Timer", pdMS_TO_TICKS(1000), pdTRUE, NULL, Update_Battery_Timer); /* Create the battery timer */
+    Battery_Flush_Timer_Handler = xTimerCreate("Battery_Flush_Timer", 1, pdFALSE, NULL, Battery_Flush_Timer);             /* Create the coalescing timer, its period is set on each start */
+
+    Sensor_Stream_Init(&Sensor_Stream_Batcher, pdMS_TO_TICKS(SENSOR_STREAM_DEADLINE_MS), Sensor_Stream_Send, NULL);                      /* Set up the sensor batcher */
+    Sensor_Timer_Handler = xTimerCreate("Sensor_Sample_Timer", pdMS_TO_TICKS(SENSOR_SAMPLE_PERIOD_MS), pdTRUE, NULL, Sensor_Sample_Timer); /* Create the sensor timer */
+    return 0;
+}
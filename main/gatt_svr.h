@@ -0,0 +1,38 @@
+/* BLE GATT example - GATT services
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef GATT_SVR_H
+#define GATT_SVR_H
+
+#include <stddef.h>      /* This is the standard C lib used for the size_t type */
+#include <stdint.h>      /* This is the standard C lib used for the fixed width integer types */
+#include <host/ble_hs.h> /* This is ESP lib used for the GATT and GAP types */
+
+extern const struct ble_gatt_svc_def GATT_Service[];                 /* GATT service definitions */
+extern uint16_t Battery_level_characteristic_attribute_handler; /* Value handle of the battery level characteristic */
+extern uint16_t Sensor_Stream_characteristic_attribute_handler; /* Value handle of the sensor stream characteristic */
+extern uint16_t Diagnostics_characteristic_attribute_handler;   /* Value handle of the diagnostics characteristic */
+
+int Gatt_Svr_Init(void);
+void Gatt_Svr_Subscribe(const struct ble_gap_event *event);
+void Gatt_Svr_Connection_Closed(void);
+
+/* Access callbacks registered in GATT_Service. They only depend on the
+ * connection table, the notification pool, the ingest ring and the
+ * diagnostics counters, and are
+ * exported so they can be driven directly, outside the NimBLE host.
+ */
+int Static_Value_Read(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg);
+int Device_Battery_Level(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg);
+int Battery_Level_Descriptor(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg);
+int Custom_Service(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg);
+void Custom_Message_Received(const uint8_t *data, size_t len, void *arg);
+int Diagnostics_Characteristic(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg);
+int Sensor_Stream_Characteristic(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg);
+
+#endif /* GATT_SVR_H */
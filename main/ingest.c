@@ -0,0 +1,121 @@
+/* BLE GATT example - write ingest pipeline
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <string.h>            /* This is the standard C lib used for memcpy */
+#include <freertos/FreeRTOS.h> /* This is ESP lib used for the FreeRTOS types */
+#include <freertos/task.h>     /* This is ESP lib used to create the worker task */
+#include "ingest.h"            /* This is the write ingest pipeline interface */
+#include "spsc_ring.h"         /* This is the lock-free ring between the tasks */
+
+/**
+ * @brief One ring slot holding a written value
+ */
+typedef struct
+{
+    uint16_t len;                   /* Length of the value */
+    uint8_t data[INGEST_MAX_FRAME]; /* Value written by the client */
+} Ingest_Frame;
+
+static Ingest_Frame Ingest_Frames[INGEST_RING_SLOTS]; /* Storage of the ring */
+static Spsc_Ring Ingest_Ring;                         /* Completed frames waiting for the worker */
+static TaskHandle_t Ingest_Task_Handle;               /* Worker woken by the producer when the ring was empty */
+static Ingest_Handler *Ingest_Frame_Handler;          /* Application function run on each frame */
+static void *Ingest_Frame_Handler_Arg;                /* Argument of Ingest_Frame_Handler */
+
+/**
+ * @brief Worker task draining the ingest ring
+ *
+ * Handles every queued frame in place, releases them to the producer in one
+ * batch, then sleeps once the ring is empty until the producer signals that
+ * it put a frame into the empty ring.
+ *
+ * @param param Pointer to the task's parameter (unused)
+ */
+static void Ingest_Task(void *param)
+{
+    for (;;)
+    {
+        size_t count;
+        Ingest_Frame *frames = Spsc_Ring_Peek(&Ingest_Ring, &count); /* Look at the queued frames */
+
+        if (frames == NULL) /* Nothing queued */
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY); /* Wait for the producer */
+            continue;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            Ingest_Frame_Handler(frames[i].data, frames[i].len, Ingest_Frame_Handler_Arg); /* Hand the frame to the application */
+        }
+        Spsc_Ring_Release(&Ingest_Ring, count);    /* Give the slots back to the producer */
+        atomic_thread_fence(memory_order_seq_cst); /* Release before the next read of head, paired with Ingest_Submit */
+    }
+}
+
+/**
+ * @brief Create the ingest ring and its worker task
+ *
+ * Must be called once, before the NimBLE host starts. The handler runs in
+ * the worker task, so it is free to block on logging or flash without
+ * holding up the NimBLE host task.
+ *
+ * @param handler Function run on each completed frame
+ * @param arg Argument passed to the handler
+ */
+void Ingest_Init(Ingest_Handler *handler, void *arg)
+{
+    Ingest_Frame_Handler = handler;
+    Ingest_Frame_Handler_Arg = arg;
+    Spsc_Ring_Init(&Ingest_Ring, Ingest_Frames, sizeof(Ingest_Frame), INGEST_RING_SLOTS); /* One slot per frame */
+    xTaskCreatePinnedToCore(Ingest_Task, "Ingest_Task", INGEST_TASK_STACK_SIZE, NULL,
+                            INGEST_TASK_PRIORITY, &Ingest_Task_Handle, INGEST_TASK_CORE); /* Start the worker away from the host task */
+}
+
+/**
+ * @brief Queue a written value for the worker task
+ *
+ * Called from the NimBLE host task. The value may arrive as a chain of
+ * mbufs (long and prepared writes are reassembled into one chain by the
+ * host before the access callback runs), so the chain is walked and each
+ * segment is copied straight into a slot reserved in the ring, with no
+ * intermediate flat buffer. Never waits for the worker: if the ring is full
+ * the frame is refused and the caller counts it as dropped. The worker is
+ * only notified when the frame went into an empty ring, since it may be
+ * asleep then; the notification enters a short kernel critical section.
+ *
+ * @param om Value written by the client
+ * @return int 0 on success, BLE_HS_ENOMEM if the frame was dropped
+ */
+int Ingest_Submit(const struct os_mbuf *om)
+{
+    uint16_t len = OS_MBUF_PKTLEN(om); /* Total length across the chain */
+    size_t count = 1;
+    Ingest_Frame *slot = len <= INGEST_MAX_FRAME ? Spsc_Ring_Reserve(&Ingest_Ring, &count) : NULL; /* Reserve a slot */
+
+    if (slot == NULL) /* Frame too long or ring full */
+    {
+        return BLE_HS_ENOMEM;
+    }
+
+    uint8_t *dst = slot->data;
+    for (const struct os_mbuf *m = om; m != NULL; m = SLIST_NEXT(m, om_next)) /* Walk every segment of the chain */
+    {
+        memcpy(dst, m->om_data, m->om_len); /* Copy the segment into the ring */
+        dst += m->om_len;
+    }
+
+    slot->len = len;
+    Spsc_Ring_Commit(&Ingest_Ring, 1);         /* Publish the frame to the worker */
+    atomic_thread_fence(memory_order_seq_cst); /* Head before the read of tail, paired with the worker */
+    if (Spsc_Ring_Count(&Ingest_Ring) == 1)    /* The ring was empty, the worker may be asleep */
+    {
+        xTaskNotifyGive(Ingest_Task_Handle);
+    }
+    return 0;
+}
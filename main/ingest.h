@@ -0,0 +1,34 @@
+/* BLE GATT example - write ingest pipeline
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <stddef.h>      /* This is the standard C lib used for the size_t type */
+#include <stdint.h>      /* This is the standard C lib used for the fixed width integer types */
+#include <host/ble_hs.h> /* This is ESP lib used for the os_mbuf type */
+
+#define INGEST_MAX_FRAME 512         /* Largest frame accepted, the maximum length of an attribute value */
+#define INGEST_RING_SLOTS 8          /* Frames the ring between the host task and the worker can hold, a power of two */
+#define INGEST_TASK_STACK_SIZE 3072  /* Stack size of the worker task */
+#define INGEST_TASK_PRIORITY 1       /* Worker priority, below the NimBLE host task */
+#define INGEST_TASK_CORE 1           /* Worker core, away from the NimBLE host task on core 0 */
+
+/**
+ * @brief Function handling one completed frame in the worker task
+ *
+ * @param data Frame contents, valid until the function returns
+ * @param len Length of the frame
+ * @param arg Argument given to Ingest_Init
+ */
+typedef void Ingest_Handler(const uint8_t *data, size_t len, void *arg);
+
+void Ingest_Init(Ingest_Handler *handler, void *arg);
+int Ingest_Submit(const struct os_mbuf *om);
+
+#endif /* INGEST_H */
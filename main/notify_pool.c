@@ -0,0 +1,87 @@
+/* BLE GATT example - dedicated notification buffer pool
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include "notify_pool.h" /* This is the notification buffer pool interface */
+
+#define NOTIFY_POOL_BLOCK_SIZE (sizeof(struct os_mbuf) + NOTIFY_POOL_BLOCK_DATA_SIZE) /* Size of one mempool block */
+
+/* Statically allocated storage for the pool. Notifications are taken from here
+ * instead of the shared msys pool, so a burst of notifications can never starve
+ * the ACL receive path of buffers.
+ */
+static os_membuf_t Notify_Pool_Memory[OS_MEMPOOL_SIZE(NOTIFY_POOL_BLOCK_COUNT, NOTIFY_POOL_BLOCK_SIZE)];
+static struct os_mempool Notify_Mempool;    /* Block allocator backing the pool */
+static struct os_mbuf_pool Notify_Mbuf_Pool; /* Mbuf pool built on top of the block allocator */
+
+static uint32_t Notify_Pool_Allocations; /* Notification buffers handed out */
+static uint32_t Notify_Pool_Failures;    /* Requests refused because the pool was exhausted */
+
+/**
+ * @brief Initialise the notification buffer pool
+ *
+ * Must be called once before the NimBLE host starts.
+ */
+void Notify_Pool_Init(void)
+{
+    os_mempool_init(&Notify_Mempool, NOTIFY_POOL_BLOCK_COUNT, NOTIFY_POOL_BLOCK_SIZE,
+                    Notify_Pool_Memory, "notify_pool");                                         /* Carve the storage into blocks */
+    os_mbuf_pool_init(&Notify_Mbuf_Pool, &Notify_Mempool, NOTIFY_POOL_BLOCK_SIZE, NOTIFY_POOL_BLOCK_COUNT); /* Wrap the blocks as mbufs */
+
+    Notify_Pool_Allocations = 0; /* Reset the counters */
+    Notify_Pool_Failures = 0;
+}
+
+/**
+ * @brief Build a notification payload from the pool
+ *
+ * The returned mbuf has leading space reserved for the headers the host
+ * prepends, and is consumed by ble_gattc_notify_custom whether or not the
+ * notification succeeds. When the pool is exhausted NULL is returned and the
+ * caller is expected to back off and retry on its next tick; blocks return to
+ * the pool as soon as the host has handed them to the controller.
+ *
+ * @param data Payload to copy into the buffer
+ * @param len Length of the payload
+ * @return struct os_mbuf* Notification buffer, or NULL if the pool is exhausted
+ */
+struct os_mbuf *Notify_Pool_Get(const void *data, uint16_t len)
+{
+    struct os_mbuf *om = os_mbuf_get_pkthdr(&Notify_Mbuf_Pool, 0); /* Take a packet header block */
+
+    if (om == NULL) /* Pool is exhausted */
+    {
+        Notify_Pool_Failures++;
+        return NULL;
+    }
+
+    om->om_data += NOTIFY_POOL_HEADROOM; /* Reserve room for the headers prepended by the host */
+
+    if (os_mbuf_append(om, data, len) != 0) /* Copy the payload, chaining more blocks if needed */
+    {
+        os_mbuf_free_chain(om); /* Give back whatever was taken */
+        Notify_Pool_Failures++;
+        return NULL;
+    }
+
+    Notify_Pool_Allocations++;
+    return om;
+}
+
+/**
+ * @brief Read the usage counters of the notification buffer pool
+ *
+ * @param stats Filled with the current counters
+ */
+void Notify_Pool_Get_Stats(Notify_Pool_Stats *stats)
+{
+    stats->allocations = Notify_Pool_Allocations;
+    stats->failures = Notify_Pool_Failures;
+    stats->block_count = Notify_Mempool.mp_num_blocks;
+    stats->in_use = Notify_Mempool.mp_num_blocks - Notify_Mempool.mp_num_free;     /* Blocks not on the free list */
+    stats->peak_in_use = Notify_Mempool.mp_num_blocks - Notify_Mempool.mp_min_free; /* Low water mark of the free list */
+}
@@ -0,0 +1,36 @@
+/* BLE GATT example - dedicated notification buffer pool
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef NOTIFY_POOL_H
+#define NOTIFY_POOL_H
+
+#include <stdint.h>      /* This is the standard C lib used for the fixed width integer types */
+#include <host/ble_hs.h> /* This is ESP lib used for the os_mbuf and os_mempool types */
+#include "conn_table.h"  /* This is the per-connection state table, used to size the pool */
+
+#define NOTIFY_POOL_BLOCK_COUNT (CONN_TABLE_SIZE * 4) /* Blocks in the pool, enough for a few notifications in flight per connection */
+#define NOTIFY_POOL_BLOCK_DATA_SIZE 128               /* Data bytes per block, longer payloads are chained */
+#define NOTIFY_POOL_HEADROOM 12                       /* Leading space for the ATT, L2CAP and HCI ACL headers */
+
+/**
+ * @brief Usage counters of the notification buffer pool
+ */
+typedef struct
+{
+    uint32_t allocations; /* Notification buffers handed out */
+    uint32_t failures;    /* Requests refused because the pool was exhausted */
+    uint16_t in_use;      /* Blocks currently held by the host */
+    uint16_t peak_in_use; /* Highest number of blocks held at once */
+    uint16_t block_count; /* Total blocks in the pool */
+} Notify_Pool_Stats;
+
+void Notify_Pool_Init(void);
+struct os_mbuf *Notify_Pool_Get(const void *data, uint16_t len);
+void Notify_Pool_Get_Stats(Notify_Pool_Stats *stats);
+
+#endif /* NOTIFY_POOL_H */
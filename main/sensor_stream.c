@@ -0,0 +1,163 @@
+/* BLE GATT example - batched sensor streaming
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <string.h>        /* This is the standard C lib used for memcpy */
+#include "sensor_stream.h" /* This is the sensor streaming interface */
+
+/**
+ * @brief Check whether the frame holds any sample
+ *
+ * @param stream Stream to check
+ * @return true if at least one sample is queued
+ */
+static bool Sensor_Stream_Pending(const Sensor_Stream *stream)
+{
+    return stream->fill > SENSOR_STREAM_HEADER_SIZE;
+}
+
+/**
+ * @brief Start a new frame carrying the current sequence number
+ *
+ * @param stream Stream to reset
+ */
+static void Sensor_Stream_Start_Frame(Sensor_Stream *stream)
+{
+    stream->frame[0] = stream->sequence & 0xFF; /* Low byte of the sequence number */
+    stream->frame[1] = stream->sequence >> 8;   /* High byte of the sequence number */
+    stream->fill = SENSOR_STREAM_HEADER_SIZE;   /* Only the header is queued */
+}
+
+/**
+ * @brief Initialise a stream
+ *
+ * The frame limit starts at the default ATT MTU until Sensor_Stream_Set_MTU
+ * reports the negotiated value.
+ *
+ * @param stream Stream to initialise
+ * @param deadline_ticks Maximum age of a queued sample before the frame is flushed
+ * @param flush Callback receiving completed frames
+ * @param arg User-defined argument for the flush callback
+ */
+void Sensor_Stream_Init(Sensor_Stream *stream, uint32_t deadline_ticks, Sensor_Stream_Flush_Fn flush, void *arg)
+{
+    stream->sequence = 0;
+    stream->first_tick = 0;
+    stream->deadline_ticks = deadline_ticks;
+    stream->flush = flush;
+    stream->arg = arg;
+    Sensor_Stream_Start_Frame(stream); /* Set fill before Sensor_Stream_Set_MTU reads it */
+    Sensor_Stream_Set_MTU(stream, 23); /* Default ATT MTU */
+}
+
+/**
+ * @brief Update the frame limit from the ATT MTU
+ *
+ * If the queued samples no longer fit under the new limit they are flushed
+ * first, so a frame never exceeds the MTU it is sent with.
+ *
+ * @param stream Stream to update
+ * @param mtu Smallest ATT MTU among the subscribed connections
+ */
+void Sensor_Stream_Set_MTU(Sensor_Stream *stream, uint16_t mtu)
+{
+    uint16_t limit = mtu - SENSOR_STREAM_ATT_OVERHEAD; /* Payload room of one notification */
+
+    if (limit > SENSOR_STREAM_MAX_FRAME) /* Never exceed the frame buffer */
+    {
+        limit = SENSOR_STREAM_MAX_FRAME;
+    }
+
+    if (stream->fill > limit) /* Queued samples would not fit any more */
+    {
+        Sensor_Stream_Flush(stream);
+    }
+    stream->limit = limit;
+}
+
+/**
+ * @brief Queue one sample
+ *
+ * The frame is flushed before the sample if it would overflow, and after it
+ * if no further sample of the same size would fit.
+ *
+ * @param stream Stream to push to
+ * @param sample Sample bytes
+ * @param len Length of the sample
+ * @param now Current tick count
+ * @return true if the sample was queued, false if it can never fit in a frame
+ */
+bool Sensor_Stream_Push(Sensor_Stream *stream, const void *sample, uint16_t len, uint32_t now)
+{
+    if (len > stream->limit - SENSOR_STREAM_HEADER_SIZE) /* Sample larger than a whole frame */
+    {
+        return false;
+    }
+
+    if (stream->fill + len > stream->limit) /* No room left in this frame */
+    {
+        Sensor_Stream_Flush(stream);
+    }
+
+    if (!Sensor_Stream_Pending(stream)) /* First sample of the frame starts the deadline */
+    {
+        stream->first_tick = now;
+    }
+
+    memcpy(&stream->frame[stream->fill], sample, len); /* Append the sample */
+    stream->fill += len;
+
+    if (stream->fill + len > stream->limit) /* Frame is full, send it right away */
+    {
+        Sensor_Stream_Flush(stream);
+    }
+    return true;
+}
+
+/**
+ * @brief Flush the frame if its oldest sample reached the deadline
+ *
+ * @param stream Stream to poll
+ * @param now Current tick count
+ */
+void Sensor_Stream_Poll(Sensor_Stream *stream, uint32_t now)
+{
+    if (Sensor_Stream_Pending(stream) && (uint32_t)(now - stream->first_tick) >= stream->deadline_ticks) /* Deadline reached */
+    {
+        Sensor_Stream_Flush(stream);
+    }
+}
+
+/**
+ * @brief Hand the queued samples to the flush callback
+ *
+ * Does nothing if no sample is queued. The sequence number advances with
+ * every frame so the client can detect dropped notifications.
+ *
+ * @param stream Stream to flush
+ */
+void Sensor_Stream_Flush(Sensor_Stream *stream)
+{
+    if (!Sensor_Stream_Pending(stream)) /* Nothing to send */
+    {
+        return;
+    }
+
+    stream->flush(stream->frame, stream->fill, stream->arg); /* Send the frame */
+    stream->sequence++;                                      /* Next frame gets the next sequence number */
+    Sensor_Stream_Start_Frame(stream);
+}
+
+/**
+ * @brief Drop the queued samples without sending them
+ *
+ * @param stream Stream to clear
+ */
+void Sensor_Stream_Discard(Sensor_Stream *stream)
+{
+    Sensor_Stream_Start_Frame(stream);
+}
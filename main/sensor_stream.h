@@ -0,0 +1,63 @@
+/* BLE GATT example - batched sensor streaming
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef SENSOR_STREAM_H
+#define SENSOR_STREAM_H
+
+#include <stdbool.h> /* This is the standard C lib used for the bool type */
+#include <stdint.h>  /* This is the standard C lib used for the fixed width integer types */
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h" /* This is ESP generated config used for the preferred ATT MTU */
+#endif
+
+#ifndef CONFIG_BT_NIMBLE_ATT_PREFERRED_MTU
+#define CONFIG_BT_NIMBLE_ATT_PREFERRED_MTU 256 /* Fallback for builds without sdkconfig.h */
+#endif
+
+#define SENSOR_STREAM_ATT_OVERHEAD 3                                                         /* Opcode and handle of a notification */
+#define SENSOR_STREAM_HEADER_SIZE 2                                                          /* Little endian sequence number at the start of each frame */
+#define SENSOR_STREAM_MAX_FRAME (CONFIG_BT_NIMBLE_ATT_PREFERRED_MTU - SENSOR_STREAM_ATT_OVERHEAD) /* Largest frame at the preferred MTU */
+
+/**
+ * @brief Callback receiving a completed frame
+ *
+ * @param frame Sequence number followed by the coalesced samples
+ * @param len Length of the frame in bytes
+ * @param arg User-defined argument
+ */
+typedef void (*Sensor_Stream_Flush_Fn)(const uint8_t *frame, uint16_t len, void *arg);
+
+/**
+ * @brief Batcher coalescing queued samples into MTU sized frames
+ *
+ * Samples are appended behind a sequence number until the next sample would
+ * not fit in MTU-3 bytes or the oldest queued sample reaches its deadline,
+ * whichever comes first. Not thread safe: push, poll and limit updates must
+ * all come from the same task.
+ */
+typedef struct
+{
+    uint8_t frame[SENSOR_STREAM_MAX_FRAME]; /* Frame under construction */
+    uint16_t fill;                          /* Bytes used in the frame, header included */
+    uint16_t limit;                         /* Frame size allowed by the current MTU */
+    uint16_t sequence;                      /* Sequence number of the frame under construction */
+    uint32_t first_tick;                    /* Tick at which the oldest queued sample was pushed */
+    uint32_t deadline_ticks;                /* Maximum age of a queued sample before flushing */
+    Sensor_Stream_Flush_Fn flush;           /* Receives completed frames */
+    void *arg;                              /* User-defined argument for the flush callback */
+} Sensor_Stream;
+
+void Sensor_Stream_Init(Sensor_Stream *stream, uint32_t deadline_ticks, Sensor_Stream_Flush_Fn flush, void *arg);
+void Sensor_Stream_Set_MTU(Sensor_Stream *stream, uint16_t mtu);
+bool Sensor_Stream_Push(Sensor_Stream *stream, const void *sample, uint16_t len, uint32_t now);
+void Sensor_Stream_Poll(Sensor_Stream *stream, uint32_t now);
+void Sensor_Stream_Flush(Sensor_Stream *stream);
+void Sensor_Stream_Discard(Sensor_Stream *stream);
+
+#endif /* SENSOR_STREAM_H */
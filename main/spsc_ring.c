@@ -0,0 +1,228 @@
+/* BLE GATT example - lock-free single-producer/single-consumer ring
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <string.h>    /* This is the standard C lib used for memcpy */
+#include "spsc_ring.h" /* This is the SPSC ring interface */
+
+/**
+ * @brief Address of an element from a free running index
+ *
+ * @param ring Ring holding the element
+ * @param index Free running element index
+ * @return unsigned char* Address of the element in the storage
+ */
+static unsigned char *Spsc_Ring_Slot(const Spsc_Ring *ring, size_t index)
+{
+    return ring->storage + (index & (ring->capacity - 1)) * ring->elem_size;
+}
+
+/**
+ * @brief Initialise a ring over caller provided storage
+ *
+ * @param ring Ring to initialise
+ * @param storage Buffer of at least capacity * elem_size bytes
+ * @param elem_size Size of one element in bytes
+ * @param capacity Number of elements, must be a power of two
+ * @return true on success, false if the capacity is not a power of two
+ */
+bool Spsc_Ring_Init(Spsc_Ring *ring, void *storage, size_t elem_size, size_t capacity)
+{
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0 || elem_size == 0) /* Masking needs a power of two */
+    {
+        return false;
+    }
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->tail_cache = 0;
+    ring->head_cache = 0;
+    ring->storage = storage;
+    ring->elem_size = elem_size;
+    ring->capacity = capacity;
+    return true;
+}
+
+/**
+ * @brief Number of elements currently queued
+ *
+ * Exact when called from either end, a snapshot otherwise.
+ *
+ * @param ring Ring to inspect
+ * @return size_t Queued elements
+ */
+size_t Spsc_Ring_Count(Spsc_Ring *ring)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return head - tail;
+}
+
+/**
+ * @brief Reserve contiguous space for the producer to fill in place
+ *
+ * Producer only. The returned region stops at the end of the storage, so
+ * fewer elements than requested may be granted even when the ring has more
+ * free space; reserve again after committing to get the remainder.
+ *
+ * @param ring Ring to reserve from
+ * @param count In: elements wanted. Out: elements granted, 0 if the ring is full
+ * @return void* Start of the reserved region, or NULL if nothing was granted
+ */
+void *Spsc_Ring_Reserve(Spsc_Ring *ring, size_t *count)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed); /* Only the producer writes head */
+    size_t free_space = ring->capacity - (head - ring->tail_cache);
+
+    if (free_space < *count) /* Looks full from the cached index, refresh it */
+    {
+        ring->tail_cache = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        free_space = ring->capacity - (head - ring->tail_cache);
+    }
+
+    size_t to_end = ring->capacity - (head & (ring->capacity - 1)); /* Room before the storage wraps */
+    size_t granted = *count;
+
+    if (granted > free_space)
+    {
+        granted = free_space;
+    }
+    if (granted > to_end)
+    {
+        granted = to_end;
+    }
+
+    *count = granted;
+    return granted ? Spsc_Ring_Slot(ring, head) : NULL;
+}
+
+/**
+ * @brief Publish elements written in place after Spsc_Ring_Reserve
+ *
+ * Producer only.
+ *
+ * @param ring Ring to publish to
+ * @param count Elements to publish, at most the number granted
+ */
+void Spsc_Ring_Commit(Spsc_Ring *ring, size_t count)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + count, memory_order_release); /* Make the elements visible to the consumer */
+}
+
+/**
+ * @brief Copy a batch of elements into the ring
+ *
+ * Producer only. Publishes the whole batch with a single index update.
+ *
+ * @param ring Ring to push to
+ * @param elems Elements to copy
+ * @param count Number of elements
+ * @return size_t Elements pushed, fewer than count if the ring filled up
+ */
+size_t Spsc_Ring_Push(Spsc_Ring *ring, const void *elems, size_t count)
+{
+    const unsigned char *src = elems;
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed); /* Only the producer writes head */
+    size_t free_space = ring->capacity - (head - ring->tail_cache);
+
+    if (free_space < count) /* Looks full from the cached index, refresh it */
+    {
+        ring->tail_cache = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        free_space = ring->capacity - (head - ring->tail_cache);
+    }
+    if (count > free_space)
+    {
+        count = free_space;
+    }
+
+    size_t to_end = ring->capacity - (head & (ring->capacity - 1)); /* Room before the storage wraps */
+    size_t first = count < to_end ? count : to_end;
+
+    memcpy(Spsc_Ring_Slot(ring, head), src, first * ring->elem_size);                            /* Up to the end of the storage */
+    memcpy(ring->storage, src + first * ring->elem_size, (count - first) * ring->elem_size);       /* Remainder from the start */
+
+    atomic_store_explicit(&ring->head, head + count, memory_order_release); /* Publish the batch */
+    return count;
+}
+
+/**
+ * @brief Access queued elements in place
+ *
+ * Consumer only. Like Spsc_Ring_Reserve, the region stops at the end of the
+ * storage.
+ *
+ * @param ring Ring to read from
+ * @param count Out: contiguous elements available, 0 if the ring is empty
+ * @return void* First queued element, or NULL if the ring is empty
+ */
+void *Spsc_Ring_Peek(Spsc_Ring *ring, size_t *count)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed); /* Only the consumer writes tail */
+    size_t available = ring->head_cache - tail;
+
+    if (available == 0) /* Looks empty from the cached index, refresh it */
+    {
+        ring->head_cache = atomic_load_explicit(&ring->head, memory_order_acquire);
+        available = ring->head_cache - tail;
+    }
+
+    size_t to_end = ring->capacity - (tail & (ring->capacity - 1)); /* Elements before the storage wraps */
+
+    *count = available < to_end ? available : to_end;
+    return *count ? Spsc_Ring_Slot(ring, tail) : NULL;
+}
+
+/**
+ * @brief Give back elements consumed in place after Spsc_Ring_Peek
+ *
+ * Consumer only.
+ *
+ * @param ring Ring to release to
+ * @param count Elements to release, at most the number peeked
+ */
+void Spsc_Ring_Release(Spsc_Ring *ring, size_t count)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + count, memory_order_release); /* Hand the space back to the producer */
+}
+
+/**
+ * @brief Copy a batch of elements out of the ring
+ *
+ * Consumer only. Releases the whole batch with a single index update.
+ *
+ * @param ring Ring to pop from
+ * @param elems Buffer receiving the elements
+ * @param max Maximum number of elements to pop
+ * @return size_t Elements popped, 0 if the ring was empty
+ */
+size_t Spsc_Ring_Pop(Spsc_Ring *ring, void *elems, size_t max)
+{
+    unsigned char *dst = elems;
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed); /* Only the consumer writes tail */
+    size_t available = ring->head_cache - tail;
+
+    if (available < max) /* Cached index may be stale, refresh it */
+    {
+        ring->head_cache = atomic_load_explicit(&ring->head, memory_order_acquire);
+        available = ring->head_cache - tail;
+    }
+    if (max > available)
+    {
+        max = available;
+    }
+
+    size_t to_end = ring->capacity - (tail & (ring->capacity - 1)); /* Elements before the storage wraps */
+    size_t first = max < to_end ? max : to_end;
+
+    memcpy(dst, Spsc_Ring_Slot(ring, tail), first * ring->elem_size);                         /* Up to the end of the storage */
+    memcpy(dst + first * ring->elem_size, ring->storage, (max - first) * ring->elem_size);   /* Remainder from the start */
+
+    atomic_store_explicit(&ring->tail, tail + max, memory_order_release); /* Release the batch */
+    return max;
+}
@@ -0,0 +1,55 @@
+/* BLE GATT example - lock-free single-producer/single-consumer ring
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdatomic.h> /* This is the standard C lib used for the atomic indices */
+#include <stdbool.h>   /* This is the standard C lib used for the bool type */
+#include <stddef.h>    /* This is the standard C lib used for the size_t type */
+
+#ifdef ESP_PLATFORM
+#define SPSC_RING_CACHE_LINE 32 /* Cache line size of the ESP32 */
+#else
+#define SPSC_RING_CACHE_LINE 64 /* Cache line size of common host CPUs */
+#endif
+
+/**
+ * @brief Lock-free ring passing fixed-size elements from one task to another
+ *
+ * Exactly one task may push and exactly one task may pop. The producer and
+ * consumer indices live on separate cache lines, and each side keeps a
+ * private copy of the other side's index so that it only reads the shared
+ * one when its copy says the ring looks full (or empty). Indices run freely
+ * and are masked on access, so the capacity must be a power of two.
+ */
+typedef struct
+{
+    _Alignas(SPSC_RING_CACHE_LINE) atomic_size_t head; /* Next element to write, owned by the producer */
+    size_t tail_cache;                                 /* Producer's copy of the consumer index */
+
+    _Alignas(SPSC_RING_CACHE_LINE) atomic_size_t tail; /* Next element to read, owned by the consumer */
+    size_t head_cache;                                 /* Consumer's copy of the producer index */
+
+    _Alignas(SPSC_RING_CACHE_LINE) unsigned char *storage; /* Element storage, capacity * elem_size bytes */
+    size_t elem_size;                                      /* Size of one element in bytes */
+    size_t capacity;                                       /* Number of elements, a power of two */
+} Spsc_Ring;
+
+bool Spsc_Ring_Init(Spsc_Ring *ring, void *storage, size_t elem_size, size_t capacity);
+size_t Spsc_Ring_Count(Spsc_Ring *ring);
+
+size_t Spsc_Ring_Push(Spsc_Ring *ring, const void *elems, size_t count);
+void *Spsc_Ring_Reserve(Spsc_Ring *ring, size_t *count);
+void Spsc_Ring_Commit(Spsc_Ring *ring, size_t count);
+
+size_t Spsc_Ring_Pop(Spsc_Ring *ring, void *elems, size_t max);
+void *Spsc_Ring_Peek(Spsc_Ring *ring, size_t *count);
+void Spsc_Ring_Release(Spsc_Ring *ring, size_t count);
+
+#endif /* SPSC_RING_H */
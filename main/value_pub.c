@@ -0,0 +1,106 @@
+/* BLE GATT example - change driven value publishing
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include "value_pub.h" /* This is the value publishing interface */
+
+/**
+ * @brief Initialise a published value
+ *
+ * @param pub Value to initialise
+ * @param value Initial value
+ * @param hysteresis Change needed before subscribers are notified again, 0 is treated as 1
+ */
+void Value_Pub_Init(Value_Pub *pub, uint8_t value, uint8_t hysteresis)
+{
+    pub->value = value;
+    pub->hysteresis = hysteresis > 0 ? hysteresis : 1; /* Never notify an unchanged value */
+    pub->updates = 0;
+    pub->notified = 0;
+}
+
+/**
+ * @brief Store a new value
+ *
+ * Only updates the cache; the caller publishes it with Value_Pub_Due and
+ * Value_Pub_Sent for each subscriber.
+ *
+ * @param pub Value to update
+ * @param value New value
+ */
+void Value_Pub_Set(Value_Pub *pub, uint8_t value)
+{
+    pub->value = value;
+    pub->updates++;
+}
+
+/**
+ * @brief Read the cached value
+ *
+ * @param pub Value to read
+ * @return uint8_t Current value
+ */
+uint8_t Value_Pub_Get(const Value_Pub *pub)
+{
+    return pub->value;
+}
+
+/**
+ * @brief Forget what a connection received
+ *
+ * The next Value_Pub_Due call reports the value as due, so a client that
+ * (re)subscribes gets the current value right away.
+ *
+ * @param conn Connection state to reset
+ */
+void Value_Pub_Reset_Conn(Value_Pub_Conn *conn)
+{
+    conn->sent = false;
+    conn->last = 0;
+    conn->last_tick = 0;
+}
+
+/**
+ * @brief Decide when a connection should be notified
+ *
+ * @param pub Published value
+ * @param conn What the connection last received
+ * @param now Current tick
+ * @param min_gap Minimum ticks between two notifications, usually one connection interval
+ * @return uint32_t 0 to notify now, ticks to wait before notifying, or VALUE_PUB_IDLE if the connection is up to date
+ */
+uint32_t Value_Pub_Due(const Value_Pub *pub, const Value_Pub_Conn *conn, uint32_t now, uint32_t min_gap)
+{
+    if (!conn->sent) /* Nothing sent yet, the first value always goes out */
+    {
+        return 0;
+    }
+
+    uint8_t delta = pub->value > conn->last ? pub->value - conn->last : conn->last - pub->value;
+    if (delta < pub->hysteresis) /* Not far enough from what the client has */
+    {
+        return VALUE_PUB_IDLE;
+    }
+
+    uint32_t elapsed = now - conn->last_tick; /* Wraps correctly with the tick counter */
+    return elapsed >= min_gap ? 0 : min_gap - elapsed;
+}
+
+/**
+ * @brief Record a notification sent to a connection
+ *
+ * @param pub Published value
+ * @param conn What the connection last received
+ * @param now Tick at which the notification was sent
+ */
+void Value_Pub_Sent(Value_Pub *pub, Value_Pub_Conn *conn, uint32_t now)
+{
+    conn->sent = true;
+    conn->last = pub->value;
+    conn->last_tick = now;
+    pub->notified++;
+}
@@ -0,0 +1,59 @@
+/* BLE GATT example - change driven value publishing
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef VALUE_PUB_H
+#define VALUE_PUB_H
+
+#include <stdbool.h> /* This is the standard C lib used for the bool type */
+#include <stdint.h>  /* This is the standard C lib used for the fixed width integer types */
+
+#define VALUE_PUB_IDLE UINT32_MAX /* Value_Pub_Due result when the connection is up to date */
+
+/**
+ * @brief Published value shared by every connection
+ *
+ * Reads are served from the cached value. A subscriber is only notified once
+ * the value moved at least `hysteresis` away from what it last received, and
+ * never more often than once per `min_gap` ticks chosen by the caller, so
+ * bursts of updates collapse into one notification carrying the latest value.
+ * Not thread safe: updates and publishing must come from the same task.
+ *
+ * The per-connection state follows the same rule. Value_Pub_Reset_Conn runs
+ * when a client subscribes and Value_Pub_Sent when it is notified; if they
+ * ran in different tasks, a subscription arriving during a notification
+ * pass could be overwritten with the old "last sent" value and the client
+ * would miss the current one. In this application both run in the NimBLE
+ * host task: the subscription comes from the GAP event handler, and the
+ * battery timers only post events to the host's queue (see Gatt_Svr_Init).
+ */
+typedef struct
+{
+    uint8_t value;      /* Current value, served to reads */
+    uint8_t hysteresis; /* Change from the last sent value needed to notify again, at least 1 */
+    uint32_t updates;   /* Values produced */
+    uint32_t notified;  /* Notifications sent */
+} Value_Pub;
+
+/**
+ * @brief What one connection last received
+ */
+typedef struct
+{
+    bool sent;          /* A value has been sent at least once */
+    uint8_t last;       /* Last value sent */
+    uint32_t last_tick; /* Tick at which the last value was sent */
+} Value_Pub_Conn;
+
+void Value_Pub_Init(Value_Pub *pub, uint8_t value, uint8_t hysteresis);
+void Value_Pub_Set(Value_Pub *pub, uint8_t value);
+uint8_t Value_Pub_Get(const Value_Pub *pub);
+void Value_Pub_Reset_Conn(Value_Pub_Conn *conn);
+uint32_t Value_Pub_Due(const Value_Pub *pub, const Value_Pub_Conn *conn, uint32_t now, uint32_t min_gap);
+void Value_Pub_Sent(Value_Pub *pub, Value_Pub_Conn *conn, uint32_t now);
+
+#endif /* VALUE_PUB_H */
@@ -0,0 +1,225 @@
+/* BLE GATT example - deferred logging against direct formatting
+
+   Checks that records logged from the host task are printed, and that
+   records from the timer task, which posts its work to the host task and
+   owns no channel, or from any other task are dropped and counted. Then
+   times one GAP connection update message written with printf, with
+   ESP_LOGI and with Deferred_Log, all to the same line buffered stream, and
+   Deferred_Log again while the flush task is stalled so that every record
+   is dropped. The stream only counts the lines, so the figures are the cost
+   of formatting and of the calls, not of a UART. Times are the CPU time of
+   the calling thread, the host task's share, so the flush task printing
+   on the same core of the build machine is not charged to the callers.
+   Run with an iteration count to override the default.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#define _GNU_SOURCE             /* This is the glibc extensions, for fopencookie */
+#include <sched.h>              /* This is the POSIX lib used to let the flush task run */
+#include <stdatomic.h>          /* This is the standard C lib used for the state shared with the flush task */
+#include <stdlib.h>             /* This is the standard C lib used for atoi */
+#include <time.h>               /* This is the POSIX lib used for the thread CPU clock */
+#include <esp_log.h>            /* This is the logging stand-in, for the ESP_LOGI comparison */
+#include <freertos/FreeRTOS.h>  /* This is the FreeRTOS stand-in types */
+#include <freertos/task.h>      /* This is the task stand-in, for a task owning no channel */
+#include <freertos/timers.h>    /* This is the timer stand-in, for a log from the timer task */
+#include "host_test.h"          /* This is the test helpers */
+#include "host_stub.h"          /* This is the stand-in control interface */
+#include "deferred_log.h"       /* This is the deferred logging under test */
+#include "diag.h"               /* This is the runtime performance counters, for the drop counts */
+
+#define BENCH_BURST (DEFERRED_LOG_RING_SLOTS / 2) /* Records logged before waiting for the flush task */
+#define BENCH_BURSTS_MAX 100                       /* Bursts timed with room in the ring, each waits up to a flush period */
+
+static atomic_uint Lines;           /* Info lines written to the stream */
+static atomic_bool Gate_Open;       /* Cleared to stall the writer inside the stream */
+static atomic_bool Unowned_Done;    /* Set once the unregistered task has logged */
+
+/**
+ * @brief CPU time used by the calling thread
+ *
+ * @return uint64_t Nanoseconds from an arbitrary start
+ */
+static uint64_t Thread_Now_Ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Write callback of the counting stream
+ *
+ * The stream is line buffered, so each call carries one line.
+ */
+static ssize_t Count_Write(void *cookie, const char *buf, size_t size)
+{
+    while (!atomic_load_explicit(&Gate_Open, memory_order_acquire)) /* Stalled by the benchmark */
+    {
+        sched_yield();
+    }
+    if (size > 0 && buf[0] == 'I') /* Drop reports are warnings, only count the records */
+    {
+        atomic_fetch_add_explicit(&Lines, 1, memory_order_release);
+    }
+    return size;
+}
+
+/**
+ * @brief Wait for a number of info lines in total
+ */
+static void Wait_Lines(unsigned count)
+{
+    while (atomic_load_explicit(&Lines, memory_order_acquire) < count)
+    {
+        sched_yield();
+    }
+}
+
+static void Timer_Log(TimerHandle_t timer)
+{
+    Deferred_Log(LOG_GAP_ADV_COMPLETE, 0, 0, 0); /* Runs in the timer task, which owns no channel */
+}
+
+static void Unowned_Task(void *param)
+{
+    Deferred_Log(LOG_GAP_ADV_COMPLETE, 0, 0, 0); /* A task that registered no channel */
+    atomic_store(&Unowned_Done, true);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+static void Test_Channels(void)
+{
+    unsigned lines = atomic_load(&Lines);
+    unsigned unregistered = atomic_load(&Diag_Counters[DIAG_LOG_UNREGISTERED]);
+    uint32_t dropped = Deferred_Log_Dropped();
+
+    Deferred_Log(LOG_GAP_MTU, 247, 0, 0); /* Host task */
+    Wait_Lines(lines + 1);
+
+    TimerHandle_t timer = xTimerCreate("Log_Timer", 1, pdFALSE, NULL, Timer_Log);
+    xTimerStart(timer, 0);
+    Stub_Tick_Advance(1); /* Fires as the timer task */
+    CHECK_EQ(atomic_load(&Diag_Counters[DIAG_LOG_UNREGISTERED]) - unregistered, 1);
+
+    TaskHandle_t task;
+    xTaskCreatePinnedToCore(Unowned_Task, "Unowned_Task", 2048, NULL, 1, &task, 1);
+    while (!atomic_load(&Unowned_Done))
+    {
+        sched_yield();
+    }
+    CHECK_EQ(atomic_load(&Diag_Counters[DIAG_LOG_UNREGISTERED]) - unregistered, 2);
+    CHECK_EQ(Deferred_Log_Dropped() - dropped, 2);
+
+    Deferred_Log(LOG_GAP_MTU, 23, 0, 0); /* Nothing of the dropped records came through */
+    Wait_Lines(lines + 2);
+    CHECK_EQ(atomic_load(&Lines), lines + 2);
+}
+
+static void Bench_Printf(FILE *stream, uint32_t iterations)
+{
+    uint64_t start = Thread_Now_Ns();
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        fprintf(stream, "I (%u) GAP: BLE_GAP_EVENT_CONN_UPDATE status %d, interval %d, budget %d B/s\n", (unsigned)i, 0, (int)i, 5249);
+    }
+    Host_Test_Report("printf", Thread_Now_Ns() - start, iterations);
+}
+
+static void Bench_Esp_Log(uint32_t iterations)
+{
+    uint64_t start = Thread_Now_Ns();
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        ESP_LOGI("GAP", "BLE_GAP_EVENT_CONN_UPDATE status %d, interval %d, budget %d B/s", 0, (int)i, 5249);
+    }
+    Host_Test_Report("ESP_LOGI", Thread_Now_Ns() - start, iterations);
+}
+
+/**
+ * @brief Time Deferred_Log with room in the ring
+ *
+ * Logs in bursts of half the ring and lets the flush task catch up between
+ * them, outside the timed part. The flush task polls, so each wait can last
+ * DEFERRED_LOG_FLUSH_MS and at most BENCH_BURSTS_MAX bursts are timed.
+ */
+static void Bench_Deferred(uint32_t iterations)
+{
+    uint32_t dropped = Deferred_Log_Dropped();
+    unsigned lines = atomic_load(&Lines);
+    uint64_t elapsed = 0;
+    uint32_t logged = 0;
+
+    if (iterations > BENCH_BURSTS_MAX * BENCH_BURST)
+    {
+        iterations = BENCH_BURSTS_MAX * BENCH_BURST;
+    }
+    while (logged < iterations)
+    {
+        uint64_t start = Thread_Now_Ns();
+        for (uint32_t i = 0; i < BENCH_BURST; i++)
+        {
+            Deferred_Log(LOG_GAP_CONN_UPDATE, 0, (int32_t)(logged + i), 5249);
+        }
+        elapsed += Thread_Now_Ns() - start;
+        logged += BENCH_BURST;
+        Wait_Lines(lines + logged);
+    }
+
+    CHECK_EQ(Deferred_Log_Dropped(), dropped); /* Every record was printed */
+    Host_Test_Report("Deferred_Log", elapsed, logged);
+}
+
+/**
+ * @brief Time Deferred_Log with the flush task stalled, so records are dropped
+ */
+static void Bench_Deferred_Full(uint32_t iterations)
+{
+    uint32_t dropped = Deferred_Log_Dropped();
+    unsigned lines = atomic_load(&Lines);
+
+    atomic_store(&Gate_Open, false); /* The flush task stops on the first record it prints */
+    Deferred_Log(LOG_GAP_MTU, 23, 0, 0);
+
+    uint64_t start = Thread_Now_Ns();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        Deferred_Log(LOG_GAP_CONN_UPDATE, 0, (int32_t)i, 5249);
+    }
+    uint64_t elapsed = Thread_Now_Ns() - start;
+
+    CHECK(Deferred_Log_Dropped() - dropped >= iterations - DEFERRED_LOG_RING_SLOTS); /* Counted, not queued */
+    atomic_store(&Gate_Open, true);
+    Wait_Lines(lines + 1 + iterations - (Deferred_Log_Dropped() - dropped));
+    Host_Test_Report("Deferred_Log, ring full", elapsed, iterations);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = argc > 1 ? (uint32_t)atoi(argv[1]) : 200000;
+    cookie_io_functions_t functions = {.write = Count_Write};
+    FILE *stream = fopencookie(NULL, "w", functions);
+
+    iterations -= iterations % BENCH_BURST;
+    setvbuf(stream, NULL, _IOLBF, BUFSIZ); /* One write per line, so the lines can be waited for */
+    atomic_store(&Gate_Open, true);
+    Stub_Log_Output(stream);
+    Deferred_Log_Init();
+    Deferred_Log_Register_Task(DEFERRED_LOG_HOST); /* The test thread stands in for the host task */
+
+    Test_Channels();
+    Bench_Printf(stream, iterations);
+    Bench_Esp_Log(iterations);
+    Bench_Deferred(iterations);
+    Bench_Deferred_Full(iterations);
+
+    Stub_Log_Output(NULL);
+    return 0;
+}
@@ -0,0 +1,163 @@
+/* BLE GATT example - cost of the GATT access callbacks and notification ticks
+
+   Drives the access callbacks registered in GATT_Service directly and the
+   notification timers through the timer stand-in, and prints the time per
+   call. Run with an iteration count to override the default.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <sched.h>       /* This is the POSIX lib used to let the ingest worker run */
+#include <stdatomic.h>   /* This is the standard C lib used for the frame counter */
+#include <stdlib.h>      /* This is the standard C lib used for atoi */
+#include "host_test.h"   /* This is the test helpers */
+#include "host_app.h"    /* This is the application bring-up */
+#include "host_stub.h"   /* This is the stand-in control interface */
+#include "gatt_svr.h"    /* This is the GATT services under test */
+#include "ingest.h"      /* This is the write ingest pipeline, for its ring size */
+#include "diag.h"        /* This is the runtime performance counters */
+
+#define BENCH_CONNECTIONS 3                       /* Centrals connected during the benchmark */
+#define BENCH_WRITE_BURST (INGEST_RING_SLOTS / 2) /* Writes made before waiting for the ingest worker */
+
+static atomic_uint Bench_Frames_Handled; /* Messages the ingest worker has handled */
+
+/**
+ * @brief Ingest handler counting the messages instead of printing them
+ */
+static void Bench_Count_Frame(const uint8_t *data, size_t len, void *arg)
+{
+    atomic_fetch_add_explicit(&Bench_Frames_Handled, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Empty a read buffer so it can be reused for the next call
+ *
+ * @param om Buffer to empty
+ */
+static void Bench_Mbuf_Rewind(struct os_mbuf *om)
+{
+    om->om_len = 0;
+    OS_MBUF_PKTLEN(om) = 0;
+}
+
+/**
+ * @brief Time a read access callback
+ *
+ * @param name Name printed with the result
+ * @param access_cb Access callback
+ * @param arg Access callback argument
+ * @param iterations Calls to make
+ */
+static void Bench_Read(const char *name, ble_gatt_access_fn *access_cb, void *arg, uint32_t iterations)
+{
+    struct ble_gatt_access_ctxt ctxt = {.op = BLE_GATT_ACCESS_OP_READ_CHR, .om = Stub_Mbuf_Get()};
+    uint64_t start = Host_Test_Now_Ns();
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        Bench_Mbuf_Rewind(ctxt.om);
+        CHECK_EQ(access_cb(1, 0, &ctxt, arg), 0);
+    }
+    Host_Test_Report(name, Host_Test_Now_Ns() - start, iterations);
+    os_mbuf_free_chain(ctxt.om);
+}
+
+/**
+ * @brief Time writes to the custom characteristic
+ *
+ * The ingest worker only counts the messages, so the figure is the cost of
+ * the callback and the copy into the ring. Writes go in bursts of half the
+ * ring and the worker drains it between them, outside the timed part, so
+ * every write is accepted and none of the time is spent refusing one.
+ *
+ * @param iterations Calls to make
+ */
+static void Bench_Write(uint32_t iterations)
+{
+    static const uint8_t value[20] = "benchmark write data";
+    struct ble_gatt_access_ctxt ctxt = {.op = BLE_GATT_ACCESS_OP_WRITE_CHR, .om = Stub_Mbuf_Chain(value, sizeof(value), 0)};
+    unsigned dropped = atomic_load(&Diag_Counters[DIAG_WRITE_DROPPED]);
+    unsigned handled = atomic_load(&Bench_Frames_Handled);
+    uint64_t elapsed = 0;
+    uint32_t written = 0;
+
+    while (written < iterations)
+    {
+        uint64_t start = Host_Test_Now_Ns();
+        for (uint32_t i = 0; i < BENCH_WRITE_BURST; i++)
+        {
+            CHECK_EQ(Custom_Service(1, 0, &ctxt, NULL), 0);
+        }
+        elapsed += Host_Test_Now_Ns() - start;
+        written += BENCH_WRITE_BURST;
+
+        while (atomic_load(&Bench_Frames_Handled) - handled < written) /* Let the worker drain the ring */
+        {
+            sched_yield();
+        }
+    }
+
+    CHECK_EQ(atomic_load(&Diag_Counters[DIAG_WRITE_DROPPED]), dropped); /* Every write was accepted */
+    Host_Test_Report("write Custom_Service (20 bytes)", elapsed, written);
+    os_mbuf_free_chain(ctxt.om);
+}
+
+/**
+ * @brief Time the notification fan-out of a timer
+ *
+ * Advances the scheduler and divides the time spent by the notifications
+ * sent, so the figure includes the timer callback, the table walk, the
+ * buffer allocation and the host call for each notification.
+ *
+ * @param name Name printed with the result
+ * @param ticks Ticks to advance
+ */
+static void Bench_Notify(const char *name, TickType_t ticks)
+{
+    uint32_t sent = Stub_Notify_State.count;
+    uint64_t start = Host_Test_Now_Ns();
+
+    Stub_Tick_Advance(ticks);
+    uint64_t elapsed = Host_Test_Now_Ns() - start;
+
+    CHECK(Stub_Notify_State.count > sent);
+    Host_Test_Report(name, elapsed, Stub_Notify_State.count - sent);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = argc > 1 ? (uint32_t)atoi(argv[1]) : 200000;
+
+    Stub_Log_Output(NULL); /* Keep the results readable */
+    Host_App_Start(Bench_Count_Frame, NULL);
+    for (uint16_t conn = 1; conn <= BENCH_CONNECTIONS; conn++)
+    {
+        Host_App_Connect(conn, 247);
+    }
+
+    const struct ble_gatt_chr_def *device_info = GATT_Service[0].characteristics;
+    const struct ble_gatt_chr_def *battery = GATT_Service[1].characteristics;
+
+    Bench_Read("read Static_Value_Read (manufacturer)", Static_Value_Read, device_info[0].arg, iterations);
+    Bench_Read("read Static_Value_Read (battery info)", Static_Value_Read, battery[0].arg, iterations);
+    Bench_Read("read Device_Battery_Level", Device_Battery_Level, NULL, iterations);
+    Bench_Read("read Diagnostics_Characteristic", Diagnostics_Characteristic, NULL, iterations / 10);
+    Bench_Write(iterations);
+
+    for (uint16_t conn = 1; conn <= BENCH_CONNECTIONS; conn++)
+    {
+        Host_App_Subscribe(conn, Battery_level_characteristic_attribute_handler, true);
+    }
+    Bench_Notify("notify battery level, 3 subscribers", (iterations / 100) * pdMS_TO_TICKS(1000)); /* One battery update per period */
+    for (uint16_t conn = 1; conn <= BENCH_CONNECTIONS; conn++)
+    {
+        Host_App_Subscribe(conn, Battery_level_characteristic_attribute_handler, false);
+        Host_App_Subscribe(conn, Sensor_Stream_characteristic_attribute_handler, true);
+    }
+    Bench_Notify("notify sensor stream, 3 subscribers", iterations / 10);
+    return 0;
+}
@@ -0,0 +1,184 @@
+/* BLE GATT example - lock-free SPSC ring throughput
+
+   Streams four-byte elements from a producer thread to a consumer thread in
+   fixed size batches, with the copying and the in-place interfaces, and
+   prints the time per element. A single-threaded run gives the cost of the
+   calls without any cross-thread traffic. Run with an element count to
+   override the default.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <pthread.h>   /* This is the POSIX lib used for the producer and consumer threads */
+#include <sched.h>     /* This is the POSIX lib used to yield when the ring is full or empty */
+#include <stdlib.h>    /* This is the standard C lib used for atoi */
+#include "host_test.h" /* This is the test helpers */
+#include "spsc_ring.h" /* This is the ring under test */
+
+#define BENCH_CAPACITY 256 /* Elements in the ring */
+#define BENCH_BATCH_MAX 32 /* Largest batch measured */
+
+/**
+ * @brief One benchmark run shared by its two threads
+ */
+typedef struct
+{
+    Spsc_Ring ring;                   /* Ring under test */
+    uint32_t storage[BENCH_CAPACITY]; /* Storage of the ring */
+    uint32_t elements;                /* Elements to stream */
+    size_t batch;                     /* Elements moved per call */
+    bool in_place;                    /* Reserve/Commit and Peek/Release instead of Push and Pop */
+    uint32_t sum;                     /* Sum of the elements received, keeps the reads alive */
+} Bench_Run;
+
+static void *Bench_Producer(void *arg)
+{
+    Bench_Run *run = arg;
+    uint32_t batch[BENCH_BATCH_MAX] = {0};
+
+    for (uint32_t next = 0; next < run->elements;)
+    {
+        size_t done = run->batch;
+
+        if (run->in_place)
+        {
+            uint32_t *slots = Spsc_Ring_Reserve(&run->ring, &done);
+            for (size_t i = 0; i < done; i++)
+            {
+                slots[i] = next + i;
+            }
+            if (done != 0)
+            {
+                Spsc_Ring_Commit(&run->ring, done);
+            }
+        }
+        else
+        {
+            batch[0] = next;
+            done = Spsc_Ring_Push(&run->ring, batch, run->batch);
+        }
+
+        next += done;
+        if (done == 0) /* Full, let the consumer run */
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *Bench_Consumer(void *arg)
+{
+    Bench_Run *run = arg;
+    uint32_t batch[BENCH_BATCH_MAX];
+
+    for (uint32_t received = 0; received < run->elements;)
+    {
+        size_t done;
+
+        if (run->in_place)
+        {
+            const uint32_t *elems = Spsc_Ring_Peek(&run->ring, &done);
+            if (done > run->batch)
+            {
+                done = run->batch;
+            }
+            for (size_t i = 0; i < done; i++)
+            {
+                run->sum += elems[i];
+            }
+            if (done != 0)
+            {
+                Spsc_Ring_Release(&run->ring, done);
+            }
+        }
+        else
+        {
+            done = Spsc_Ring_Pop(&run->ring, batch, run->batch);
+            for (size_t i = 0; i < done; i++)
+            {
+                run->sum += batch[i];
+            }
+        }
+
+        received += done;
+        if (done == 0) /* Empty, let the producer run */
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Time one interface and batch size across two threads
+ */
+static void Bench_Threads(uint32_t elements, size_t batch, bool in_place)
+{
+    static Bench_Run run;
+    pthread_t threads[2];
+    char name[64];
+
+    run = (Bench_Run){.elements = elements - elements % batch, .batch = batch, .in_place = in_place};
+    Spsc_Ring_Init(&run.ring, run.storage, sizeof(run.storage[0]), BENCH_CAPACITY);
+
+    uint64_t start = Host_Test_Now_Ns();
+    pthread_create(&threads[0], NULL, Bench_Consumer, &run);
+    pthread_create(&threads[1], NULL, Bench_Producer, &run);
+    pthread_join(threads[1], NULL);
+    pthread_join(threads[0], NULL);
+    uint64_t elapsed = Host_Test_Now_Ns() - start;
+
+    snprintf(name, sizeof(name), "2 threads, %s, batch %zu", in_place ? "in place" : "push/pop", batch);
+    Host_Test_Report(name, elapsed, run.elements);
+}
+
+/**
+ * @brief Time a push and a pop of one batch on a single thread
+ */
+static void Bench_Single(uint32_t elements, size_t batch)
+{
+    static Spsc_Ring ring;
+    static uint32_t storage[BENCH_CAPACITY];
+    uint32_t in[BENCH_BATCH_MAX] = {0};
+    uint32_t out[BENCH_BATCH_MAX];
+    uint64_t sum = 0;
+    char name[64];
+
+    Spsc_Ring_Init(&ring, storage, sizeof(storage[0]), BENCH_CAPACITY);
+
+    uint64_t start = Host_Test_Now_Ns();
+    for (uint32_t i = 0; i < elements / batch; i++)
+    {
+        in[0] = i;
+        Spsc_Ring_Push(&ring, in, batch);
+        Spsc_Ring_Pop(&ring, out, batch);
+        sum += out[0];
+    }
+    uint64_t elapsed = Host_Test_Now_Ns() - start;
+
+    uint64_t calls = elements / batch;
+    CHECK(sum == calls * (calls - 1) / 2); /* Every batch went through */
+    snprintf(name, sizeof(name), "1 thread, push/pop, batch %zu", batch);
+    Host_Test_Report(name, elapsed, elements - elements % batch);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t elements = argc > 1 ? (uint32_t)atoi(argv[1]) : 4000000;
+    static const size_t batches[] = {1, 8, BENCH_BATCH_MAX};
+
+    for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); b++)
+    {
+        Bench_Single(elements, batches[b]);
+    }
+    for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); b++)
+    {
+        Bench_Threads(elements, batches[b], false);
+        Bench_Threads(elements, batches[b], true);
+    }
+    return 0;
+}
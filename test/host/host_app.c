@@ -0,0 +1,174 @@
+/* BLE GATT example - application bring-up and GAP helpers for the host tests
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <host/ble_hs.h>  /* This is the NimBLE host stand-in */
+#include "host_app.h"     /* This is the helper interface */
+#include "host_stub.h"    /* This is the stand-in control interface */
+#include "gatt_svr.h"     /* This is the GATT services */
+#include "gap_svr.h"      /* This is the GAP event handling */
+#include "conn_table.h"   /* This is the per-connection state table */
+#include "notify_pool.h"  /* This is the notification buffer pool */
+#include "ingest.h"       /* This is the write ingest pipeline */
+#include "deferred_log.h" /* This is the deferred logging */
+
+/**
+ * @brief Bring the application up the way app_main does, then sync the host
+ *
+ * Only the NimBLE port, the controller and NVS are left out. Must be called
+ * once, before anything else.
+ *
+ * @param ingest_handler Function run on each written message, NULL for the application's Custom_Message_Received
+ * @param ingest_arg Argument of ingest_handler
+ */
+void Host_App_Start(Ingest_Handler *ingest_handler, void *ingest_arg)
+{
+    Gatt_Svr_Init();                     /* Add the GATT services and their timers */
+    ble_hs_cfg.sync_cb = BLE_app_on_sync; /* Set the synchronization callback */
+
+    if (ingest_handler == NULL)
+    {
+        ingest_handler = Custom_Message_Received; /* Print the messages, as the application does */
+    }
+
+    Conn_Table_Init();                             /* Free every connection slot */
+    Notify_Pool_Init();                            /* Set up the notification buffer pool */
+    Ingest_Init(ingest_handler, ingest_arg);       /* Start the write ingest worker */
+    Deferred_Log_Init();                           /* Start the log flush task */
+    Deferred_Log_Register_Task(DEFERRED_LOG_HOST); /* The calling thread stands in for the host task, as Host_task does */
+    Gap_Svr_Init();                                /* Start with a fast advertising burst */
+
+    ble_hs_cfg.sync_cb(); /* The host is in sync, start advertising */
+}
+
+/**
+ * @brief Connect a central and complete its MTU exchange
+ *
+ * @param conn_handle Connection handle
+ * @param mtu ATT MTU reported for the connection, 0 to skip the exchange
+ */
+void Host_App_Connect(uint16_t conn_handle, uint16_t mtu)
+{
+    struct ble_gap_event event = {.type = BLE_GAP_EVENT_CONNECT};
+
+    Stub_Gap_Set_Conn(conn_handle, 24, 0, 400); /* 30 ms interval, 4 s supervision timeout */
+    Stub_Gap_State.adv_active = false;          /* The controller stops advertising on a connection */
+    event.connect.status = 0;
+    event.connect.conn_handle = conn_handle;
+    BLE_gap_event(&event, NULL);
+
+    if (mtu != 0)
+    {
+        event = (struct ble_gap_event){.type = BLE_GAP_EVENT_MTU};
+        event.mtu.conn_handle = conn_handle;
+        event.mtu.value = mtu;
+        BLE_gap_event(&event, NULL);
+    }
+}
+
+/**
+ * @brief Disconnect a central
+ *
+ * @param conn_handle Connection handle
+ */
+void Host_App_Disconnect(uint16_t conn_handle)
+{
+    struct ble_gap_event event = {.type = BLE_GAP_EVENT_DISCONNECT};
+
+    Stub_Gap_Drop_Conn(conn_handle);
+    event.disconnect.reason = 0x213; /* Remote user terminated the connection */
+    event.disconnect.conn.conn_handle = conn_handle;
+    BLE_gap_event(&event, NULL);
+}
+
+/**
+ * @brief Enable or disable notifications of a characteristic for a central
+ *
+ * @param conn_handle Connection handle
+ * @param attr_handle Value handle of the characteristic
+ * @param notify true to enable notifications
+ */
+void Host_App_Subscribe(uint16_t conn_handle, uint16_t attr_handle, bool notify)
+{
+    struct ble_gap_event event = {.type = BLE_GAP_EVENT_SUBSCRIBE};
+
+    event.subscribe.conn_handle = conn_handle;
+    event.subscribe.attr_handle = attr_handle;
+    event.subscribe.cur_notify = notify;
+    BLE_gap_event(&event, NULL);
+}
+
+/**
+ * @brief Read a characteristic through its access callback
+ *
+ * @param access_cb Access callback of the characteristic
+ * @param conn_handle Connection handle
+ * @param arg Access callback argument registered with the characteristic
+ * @param out Filled with the value
+ * @param len In: size of out, out: length of the value
+ * @return int Value returned by the access callback
+ */
+int Host_App_Read(ble_gatt_access_fn *access_cb, uint16_t conn_handle, void *arg, uint8_t *out, uint16_t *len)
+{
+    struct ble_gatt_access_ctxt ctxt = {.op = BLE_GATT_ACCESS_OP_READ_CHR, .om = Stub_Mbuf_Get()};
+    int rc = access_cb(conn_handle, 0, &ctxt, arg);
+
+    ble_hs_mbuf_to_flat(ctxt.om, out, *len, len);
+    os_mbuf_free_chain(ctxt.om);
+    return rc;
+}
+
+/**
+ * @brief Read one part of a characteristic, as the host answers a Read or Read Blob request
+ *
+ * The access callback returns the whole value and the host sends the part
+ * starting at the requested offset, as much of it as one response holds.
+ *
+ * @param access_cb Access callback of the characteristic
+ * @param conn_handle Connection handle
+ * @param arg Access callback argument registered with the characteristic
+ * @param offset Offset of the part, 0 for a Read request
+ * @param mtu ATT MTU of the connection
+ * @param out Filled with the part, at least mtu - 1 bytes
+ * @param len Out: length of the part
+ * @return int Value returned by the access callback
+ */
+int Host_App_Read_Part(ble_gatt_access_fn *access_cb, uint16_t conn_handle, void *arg, uint16_t offset, uint16_t mtu, uint8_t *out, uint16_t *len)
+{
+    struct ble_gatt_access_ctxt ctxt = {.op = BLE_GATT_ACCESS_OP_READ_CHR, .om = Stub_Mbuf_Get()};
+    int rc = access_cb(conn_handle, 0, &ctxt, arg);
+    uint16_t value_len = OS_MBUF_PKTLEN(ctxt.om);
+
+    *len = offset < value_len ? value_len - offset : 0;
+    if (*len > mtu - 1)
+    {
+        *len = mtu - 1;
+    }
+    os_mbuf_copydata(ctxt.om, offset, *len, out);
+    os_mbuf_free_chain(ctxt.om);
+    return rc;
+}
+
+/**
+ * @brief Write a characteristic through its access callback
+ *
+ * @param access_cb Access callback of the characteristic
+ * @param conn_handle Connection handle
+ * @param arg Access callback argument registered with the characteristic
+ * @param data Value to write
+ * @param len Length of the value
+ * @param segment Bytes per mbuf of the written value, 0 for a single mbuf
+ * @return int Value returned by the access callback
+ */
+int Host_App_Write(ble_gatt_access_fn *access_cb, uint16_t conn_handle, void *arg, const void *data, uint16_t len, uint16_t segment)
+{
+    struct ble_gatt_access_ctxt ctxt = {.op = BLE_GATT_ACCESS_OP_WRITE_CHR, .om = Stub_Mbuf_Chain(data, len, segment)};
+    int rc = access_cb(conn_handle, 0, &ctxt, arg);
+
+    os_mbuf_free_chain(ctxt.om);
+    return rc;
+}
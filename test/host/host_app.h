@@ -0,0 +1,25 @@
+/* BLE GATT example - application bring-up and GAP helpers for the host tests
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef HOST_APP_H
+#define HOST_APP_H
+
+#include <stdbool.h>     /* This is the standard C lib used for the bool type */
+#include <stdint.h>      /* This is the standard C lib used for the fixed width integer types */
+#include <host/ble_hs.h> /* This is the NimBLE host stand-in */
+#include "ingest.h"      /* This is the write ingest pipeline, for its handler type */
+
+void Host_App_Start(Ingest_Handler *ingest_handler, void *ingest_arg);
+void Host_App_Connect(uint16_t conn_handle, uint16_t mtu);
+void Host_App_Disconnect(uint16_t conn_handle);
+void Host_App_Subscribe(uint16_t conn_handle, uint16_t attr_handle, bool notify);
+int Host_App_Read(ble_gatt_access_fn *access_cb, uint16_t conn_handle, void *arg, uint8_t *out, uint16_t *len);
+int Host_App_Read_Part(ble_gatt_access_fn *access_cb, uint16_t conn_handle, void *arg, uint16_t offset, uint16_t mtu, uint8_t *out, uint16_t *len);
+int Host_App_Write(ble_gatt_access_fn *access_cb, uint16_t conn_handle, void *arg, const void *data, uint16_t len, uint16_t segment);
+
+#endif /* HOST_APP_H */
@@ -0,0 +1,67 @@
+/* BLE GATT example - helpers shared by the host tests and benchmarks
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdint.h> /* This is the standard C lib used for the fixed width integer types */
+#include <stdio.h>  /* This is the standard C lib used to report failures */
+#include <stdlib.h> /* This is the standard C lib used for exit */
+#include <time.h>   /* This is the standard C lib used for the monotonic clock */
+
+/* Stop the test with the failing expression and its location */
+#define CHECK(cond)                                                                 \
+    do                                                                              \
+    {                                                                               \
+        if (!(cond))                                                                \
+        {                                                                           \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                                \
+        }                                                                           \
+    } while (0)
+
+/* Stop the test with both values when they differ */
+#define CHECK_EQ(actual, expected)                                                                   \
+    do                                                                                               \
+    {                                                                                                \
+        long long check_actual = (long long)(actual);                                                \
+        long long check_expected = (long long)(expected);                                            \
+        if (check_actual != check_expected)                                                          \
+        {                                                                                            \
+            fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %lld, expected %s == %lld\n", __FILE__, \
+                    __LINE__, #actual, check_actual, #expected, check_expected);                     \
+            exit(1);                                                                                 \
+        }                                                                                            \
+    } while (0)
+
+/**
+ * @brief Monotonic time for the benchmarks
+ *
+ * @return uint64_t Nanoseconds from an arbitrary start
+ */
+static inline uint64_t Host_Test_Now_Ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Print one benchmark result
+ *
+ * @param name What was measured
+ * @param elapsed_ns Total time
+ * @param count Operations done in that time
+ */
+static inline void Host_Test_Report(const char *name, uint64_t elapsed_ns, uint64_t count)
+{
+    printf("%-40s %10.1f ns/op  (%llu ops)\n", name, count != 0 ? (double)elapsed_ns / (double)count : 0.0, (unsigned long long)count);
+}
+
+#endif /* HOST_TEST_H */
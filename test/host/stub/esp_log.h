@@ -0,0 +1,67 @@
+/* BLE GATT example - host stand-in for the ESP logging library
+
+   The macros expand the same way as the ESP-IDF ones, so every format
+   string is still checked against its arguments. Output goes through
+   esp_log_write to the stream chosen with Stub_Log_Output.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef STUB_ESP_LOG_H
+#define STUB_ESP_LOG_H
+
+#include <stdint.h> /* This is the standard C lib used for the fixed width integer types */
+
+typedef enum
+{
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+#ifndef LOG_LOCAL_LEVEL
+#define LOG_LOCAL_LEVEL ESP_LOG_INFO /* Same default as CONFIG_LOG_DEFAULT_LEVEL */
+#endif
+
+uint32_t esp_log_timestamp(void);
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+#define LOG_FORMAT(letter, format) #letter " (%u) %s: " format "\n"
+
+#define ESP_LOG_LEVEL(level, tag, format, ...)                                                                              \
+    do                                                                                                                      \
+    {                                                                                                                       \
+        if (level == ESP_LOG_ERROR)                                                                                         \
+        {                                                                                                                   \
+            esp_log_write(ESP_LOG_ERROR, tag, LOG_FORMAT(E, format), (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__); \
+        }                                                                                                                   \
+        else if (level == ESP_LOG_WARN)                                                                                     \
+        {                                                                                                                   \
+            esp_log_write(ESP_LOG_WARN, tag, LOG_FORMAT(W, format), (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__);   \
+        }                                                                                                                   \
+        else                                                                                                                \
+        {                                                                                                                   \
+            esp_log_write(ESP_LOG_INFO, tag, LOG_FORMAT(I, format), (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__);   \
+        }                                                                                                                   \
+    } while (0)
+
+#define ESP_LOG_LEVEL_LOCAL(level, tag, format, ...)               \
+    do                                                             \
+    {                                                              \
+        if (LOG_LOCAL_LEVEL >= level)                              \
+        {                                                          \
+            ESP_LOG_LEVEL(level, tag, format, ##__VA_ARGS__);      \
+        }                                                          \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+
+#endif /* STUB_ESP_LOG_H */
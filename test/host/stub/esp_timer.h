@@ -0,0 +1,16 @@
+/* BLE GATT example - host stand-in for the ESP high resolution timer
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef STUB_ESP_TIMER_H
+#define STUB_ESP_TIMER_H
+
+#include <stdint.h> /* This is the standard C lib used for the fixed width integer types */
+
+int64_t esp_timer_get_time(void);
+
+#endif /* STUB_ESP_TIMER_H */
@@ -0,0 +1,28 @@
+/* BLE GATT example - host stand-in for FreeRTOS
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef STUB_FREERTOS_H
+#define STUB_FREERTOS_H
+
+#include <stdint.h> /* This is the standard C lib used for the fixed width integer types */
+
+typedef uint32_t TickType_t;  /* Scheduler ticks, advanced by Stub_Tick_Advance */
+typedef int BaseType_t;       /* Signed return type of the FreeRTOS API */
+typedef unsigned UBaseType_t; /* Unsigned parameter type of the FreeRTOS API */
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFFu
+#define configTICK_RATE_HZ 100                                                         /* Matches CONFIG_FREERTOS_HZ in sdkconfig */
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)                                 /* Length of one tick */
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000)) /* Same rounding as FreeRTOS */
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+#endif /* STUB_FREERTOS_H */
@@ -0,0 +1,25 @@
+/* BLE GATT example - host stand-in for FreeRTOS tasks
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef STUB_TASK_H
+#define STUB_TASK_H
+
+#include "freertos/FreeRTOS.h" /* This is the FreeRTOS stand-in types */
+
+typedef struct Stub_Task *TaskHandle_t;  /* Tasks run as POSIX threads */
+typedef void (*TaskFunction_t)(void *); /* Task entry point */
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stack_depth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+
+#endif /* STUB_TASK_H */
@@ -0,0 +1,27 @@
+/* BLE GATT example - host stand-in for FreeRTOS software timers
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef STUB_TIMERS_H
+#define STUB_TIMERS_H
+
+#include "freertos/FreeRTOS.h" /* This is the FreeRTOS stand-in types */
+#include "freertos/task.h"     /* This is the task stand-in, for the timer task handle */
+
+typedef struct Stub_Timer *TimerHandle_t;                 /* Timers fire from Stub_Tick_Advance */
+typedef TimerHandle_t xTimerHandle;                       /* Legacy name used by the application */
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t); /* Timer callback */
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload, void *id, TimerCallbackFunction_t callback);
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks_to_wait);
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks_to_wait);
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticks_to_wait);
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks_to_wait);
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer);
+TaskHandle_t xTimerGetTimerDaemonTaskHandle(void);
+
+#endif /* STUB_TIMERS_H */
@@ -0,0 +1,297 @@
+/* BLE GATT example - host stand-in for the NimBLE host API
+
+   Only the types, constants and calls the application uses, with the same
+   names and values as the NimBLE host shipped with ESP-IDF. The calls are
+   implemented in stub_nimble.c and are driven through host_stub.h.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef STUB_BLE_HS_H
+#define STUB_BLE_HS_H
+
+#include <stdbool.h>   /* This is the standard C lib used for the bool type */
+#include <stdint.h>    /* This is the standard C lib used for the fixed width integer types */
+#include "os/os_mbuf.h" /* This is the mbuf stand-in */
+
+#define BLE_HS_FOREVER INT32_MAX /* Advertise until stopped */
+
+#define BLE_HS_EALREADY 2 /* Operation already in progress */
+#define BLE_HS_EINVAL 3   /* Bad argument */
+#define BLE_HS_EMSGSIZE 4 /* Buffer too small */
+#define BLE_HS_ENOMEM 6   /* Out of buffers */
+#define BLE_HS_ENOTCONN 7 /* No such connection */
+#define BLE_HS_ENOTSUP 8  /* Not supported by the controller */
+#define BLE_HS_EBUSY 15   /* Procedure already running */
+
+#define BLE_ERR_CONN_LIMIT 0x09 /* HCI reason: connection limit exceeded */
+
+#define BLE_ATT_ERR_READ_NOT_PERMITTED 0x02
+#define BLE_ATT_ERR_UNLIKELY 0x0e
+#define BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN 0x0d
+#define BLE_ATT_ERR_INSUFFICIENT_RES 0x11
+#define BLE_ATT_MTU_DFLT 23
+
+/* UUIDs */
+typedef struct
+{
+    uint8_t type; /* 16 or 128 */
+} ble_uuid_t;
+
+typedef struct
+{
+    ble_uuid_t u;
+    uint16_t value;
+} ble_uuid16_t;
+
+typedef struct
+{
+    ble_uuid_t u;
+    uint8_t value[16];
+} ble_uuid128_t;
+
+#define BLE_UUID16_INIT(uuid16) {.u = {.type = 16}, .value = (uuid16)}
+#define BLE_UUID128_INIT(...) {.u = {.type = 128}, .value = {__VA_ARGS__}}
+#define BLE_UUID16_DECLARE(uuid16) ((ble_uuid_t *)(&(ble_uuid16_t)BLE_UUID16_INIT(uuid16)))
+#define BLE_UUID128_DECLARE(...) ((ble_uuid_t *)(&(ble_uuid128_t)BLE_UUID128_INIT(__VA_ARGS__)))
+
+/* GATT server */
+#define BLE_GATT_CHR_F_READ 0x0002
+#define BLE_GATT_CHR_F_WRITE_NO_RSP 0x0004
+#define BLE_GATT_CHR_F_WRITE 0x0008
+#define BLE_GATT_CHR_F_NOTIFY 0x0010
+
+#define BLE_GATT_ACCESS_OP_READ_CHR 0
+#define BLE_GATT_ACCESS_OP_WRITE_CHR 1
+#define BLE_GATT_ACCESS_OP_READ_DSC 2
+#define BLE_GATT_ACCESS_OP_WRITE_DSC 3
+
+#define BLE_GATT_SVC_TYPE_END 0
+#define BLE_GATT_SVC_TYPE_PRIMARY 1
+
+struct ble_gatt_chr_def;
+struct ble_gatt_dsc_def;
+
+/**
+ * @brief Context handed to an access callback
+ */
+struct ble_gatt_access_ctxt
+{
+    uint8_t op;          /* BLE_GATT_ACCESS_OP_* */
+    struct os_mbuf *om; /* Value to append to on reads, value written on writes */
+    union
+    {
+        const struct ble_gatt_chr_def *chr;
+        const struct ble_gatt_dsc_def *dsc;
+    };
+};
+
+typedef int ble_gatt_access_fn(uint16_t conn_handle, uint16_t attr_handle, struct ble_gatt_access_ctxt *ctxt, void *arg);
+typedef uint16_t ble_gatt_chr_flags;
+
+struct ble_gatt_dsc_def
+{
+    const ble_uuid_t *uuid;
+    uint8_t att_flags;
+    uint8_t min_key_size;
+    ble_gatt_access_fn *access_cb;
+    void *arg;
+};
+
+struct ble_gatt_chr_def
+{
+    const ble_uuid_t *uuid;
+    ble_gatt_access_fn *access_cb;
+    void *arg;
+    struct ble_gatt_dsc_def *descriptors;
+    ble_gatt_chr_flags flags;
+    uint8_t min_key_size;
+    uint16_t *val_handle;
+};
+
+struct ble_gatt_svc_def
+{
+    uint8_t type;
+    const ble_uuid_t *uuid;
+    const struct ble_gatt_svc_def **includes;
+    const struct ble_gatt_chr_def *characteristics;
+};
+
+int ble_gatts_count_cfg(const struct ble_gatt_svc_def *defs);
+int ble_gatts_add_svcs(const struct ble_gatt_svc_def *svcs);
+int ble_gattc_notify_custom(uint16_t conn_handle, uint16_t att_handle, struct os_mbuf *om);
+int ble_gattc_exchange_mtu(uint16_t conn_handle, void *cb, void *cb_arg);
+int ble_hs_mbuf_to_flat(const struct os_mbuf *om, void *flat, uint16_t max_len, uint16_t *out_copy_len);
+int ble_hs_id_infer_auto(int privacy, uint8_t *out_addr_type);
+
+/**
+ * @brief Host configuration, only the callbacks the application sets
+ */
+struct ble_hs_cfg
+{
+    void (*reset_cb)(int reason);
+    void (*sync_cb)(void);
+};
+extern struct ble_hs_cfg ble_hs_cfg;
+
+/* GAP */
+#define BLE_GAP_EVENT_CONNECT 0
+#define BLE_GAP_EVENT_DISCONNECT 1
+#define BLE_GAP_EVENT_CONN_UPDATE 3
+#define BLE_GAP_EVENT_CONN_UPDATE_REQ 4
+#define BLE_GAP_EVENT_ADV_COMPLETE 9
+#define BLE_GAP_EVENT_NOTIFY_TX 13
+#define BLE_GAP_EVENT_SUBSCRIBE 14
+#define BLE_GAP_EVENT_MTU 15
+#define BLE_GAP_EVENT_PHY_UPDATE_COMPLETE 18
+
+#define BLE_GAP_CONN_MODE_UND 2
+#define BLE_GAP_DISC_MODE_GEN 2
+
+#define BLE_GAP_LE_PHY_1M 1
+#define BLE_GAP_LE_PHY_2M 2
+#define BLE_GAP_LE_PHY_CODED 3
+#define BLE_GAP_LE_PHY_1M_MASK 0x01
+#define BLE_GAP_LE_PHY_2M_MASK 0x02
+#define BLE_GAP_LE_PHY_CODED_MASK 0x04
+#define BLE_GAP_LE_PHY_CODED_ANY 0
+
+#define BLE_GAP_ADV_ITVL_MS(t) ((t) * 1000 / 625)
+#define BLE_GAP_CONN_ITVL_MS(t) ((t) * 1000 / 1250)
+#define BLE_GAP_SUPERVISION_TIMEOUT_MS(t) ((t) / 10)
+
+struct ble_gap_conn_desc
+{
+    uint16_t conn_handle;
+    uint16_t conn_itvl;           /* 1.25 ms units */
+    uint16_t conn_latency;        /* Connection events */
+    uint16_t supervision_timeout; /* 10 ms units */
+};
+
+struct ble_gap_upd_params
+{
+    uint16_t itvl_min;
+    uint16_t itvl_max;
+    uint16_t latency;
+    uint16_t supervision_timeout;
+    uint16_t min_ce_len;
+    uint16_t max_ce_len;
+};
+
+/**
+ * @brief GAP event, only the members the application reads
+ */
+struct ble_gap_event
+{
+    uint8_t type; /* BLE_GAP_EVENT_* */
+    union
+    {
+        struct
+        {
+            int status;
+            uint16_t conn_handle;
+        } connect;
+
+        struct
+        {
+            int reason;
+            struct ble_gap_conn_desc conn;
+        } disconnect;
+
+        struct
+        {
+            int status;
+            uint16_t conn_handle;
+        } conn_update;
+
+        struct
+        {
+            int reason;
+        } adv_complete;
+
+        struct
+        {
+            int status;
+            uint16_t conn_handle;
+            uint16_t attr_handle;
+            uint8_t indication : 1;
+        } notify_tx;
+
+        struct
+        {
+            uint16_t conn_handle;
+            uint16_t attr_handle;
+            uint8_t reason;
+            uint8_t prev_notify : 1;
+            uint8_t cur_notify : 1;
+            uint8_t prev_indicate : 1;
+            uint8_t cur_indicate : 1;
+        } subscribe;
+
+        struct
+        {
+            uint16_t conn_handle;
+            uint16_t channel_id;
+            uint16_t value;
+        } mtu;
+
+        struct
+        {
+            int status;
+            uint16_t conn_handle;
+            uint8_t tx_phy;
+            uint8_t rx_phy;
+        } phy_updated;
+    };
+};
+
+typedef int ble_gap_event_fn(struct ble_gap_event *event, void *arg);
+
+struct ble_gap_adv_params
+{
+    uint8_t conn_mode;
+    uint8_t disc_mode;
+    uint16_t itvl_min; /* 0.625 ms units */
+    uint16_t itvl_max; /* 0.625 ms units */
+    uint8_t channel_map;
+    uint8_t filter_policy;
+    uint8_t high_duty_cycle;
+};
+
+int ble_gap_adv_set_data(const uint8_t *data, int data_len);
+int ble_gap_adv_rsp_set_data(const uint8_t *data, int data_len);
+int ble_gap_adv_start(uint8_t own_addr_type, const void *direct_addr, int32_t duration_ms,
+                      const struct ble_gap_adv_params *adv_params, ble_gap_event_fn *cb, void *cb_arg);
+int ble_gap_adv_stop(void);
+int ble_gap_adv_active(void);
+int ble_gap_update_params(uint16_t conn_handle, const struct ble_gap_upd_params *params);
+int ble_gap_set_prefered_le_phy(uint16_t conn_handle, uint8_t tx_phys_mask, uint8_t rx_phys_mask, uint16_t phy_opts);
+int ble_gap_set_data_len(uint16_t conn_handle, uint16_t tx_octets, uint16_t tx_time);
+int ble_gap_conn_find(uint16_t conn_handle, struct ble_gap_conn_desc *out_desc);
+int ble_gap_terminate(uint16_t conn_handle, uint8_t hci_reason);
+
+/* Advertising payload encoding */
+#define BLE_HS_ADV_MAX_SZ 31
+#define BLE_HS_ADV_F_DISC_LTD 0x01
+#define BLE_HS_ADV_F_DISC_GEN 0x02
+#define BLE_HS_ADV_TX_PWR_LVL_AUTO (-128)
+
+struct ble_hs_adv_fields
+{
+    uint8_t flags;
+    const ble_uuid128_t *uuids128;
+    uint8_t num_uuids128;
+    unsigned uuids128_is_complete : 1;
+    const uint8_t *name;
+    uint8_t name_len;
+    unsigned name_is_complete : 1;
+    int8_t tx_pwr_lvl;
+    unsigned tx_pwr_lvl_is_present : 1;
+};
+
+int ble_hs_adv_set_fields(const struct ble_hs_adv_fields *adv_fields, uint8_t *dst, uint8_t *dst_len, uint8_t max_len);
+
+#endif /* STUB_BLE_HS_H */
@@ -0,0 +1,90 @@
+/* BLE GATT example - control of the host stand-ins
+
+   The stand-ins replace FreeRTOS and the NimBLE host so the application
+   modules can run on a Linux host. Tasks are POSIX threads; software timers
+   only fire from Stub_Tick_Advance, on the calling thread, which acts as the
+   FreeRTOS timer task while they run and then as the NimBLE host task to run
+   the events they posted to the default event queue. Any other thread that
+   was not started as a task also acts as the host task. Notifications and
+   GAP procedures are recorded here instead of being sent.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef HOST_STUB_H
+#define HOST_STUB_H
+
+#include <stdbool.h>           /* This is the standard C lib used for the bool type */
+#include <stdint.h>            /* This is the standard C lib used for the fixed width integer types */
+#include <stdio.h>             /* This is the standard C lib used for the FILE type */
+#include <host/ble_hs.h>       /* This is the NimBLE host stand-in */
+#include <freertos/FreeRTOS.h> /* This is the FreeRTOS stand-in types */
+
+#define STUB_NOTIFY_MAX_HELD 64 /* Notifications Stub_Notify can keep in the controller at once */
+
+/**
+ * @brief Notifications handed to ble_gattc_notify_custom
+ */
+typedef struct
+{
+    uint32_t count;                         /* Notifications accepted */
+    uint32_t bytes;                         /* Payload bytes accepted */
+    int rc;                                 /* Value returned by the next calls, 0 to accept them */
+    bool hold;                              /* Keep the buffers as if the controller had not sent them yet */
+    struct os_mbuf *held[STUB_NOTIFY_MAX_HELD]; /* Buffers kept while hold is set */
+    uint32_t held_count;                    /* Entries used in held */
+    uint16_t last_conn;                     /* Connection of the last notification */
+    uint16_t last_handle;                   /* Attribute of the last notification */
+    uint16_t last_len;                      /* Length of the last notification */
+    uint8_t last_data[512];                 /* Value of the last notification */
+    void (*hook)(uint16_t conn_handle, uint16_t attr_handle, const uint8_t *data, uint16_t len, void *arg); /* Called for each accepted notification */
+    void *hook_arg;                         /* Argument of hook */
+} Stub_Notify;
+
+/**
+ * @brief GAP and GATT client procedures started by the application
+ */
+typedef struct
+{
+    uint32_t adv_starts;                  /* Calls to ble_gap_adv_start */
+    int32_t adv_duration_ms;              /* Duration of the last advertising run */
+    struct ble_gap_adv_params adv_params; /* Parameters of the last advertising run */
+    bool adv_active;                      /* Advertising running */
+    uint8_t adv_data[BLE_HS_ADV_MAX_SZ];  /* Advertising payload set */
+    int adv_data_len;                     /* Length of adv_data */
+    uint32_t update_params_calls;         /* Calls to ble_gap_update_params */
+    int update_params_rc;                 /* Value returned by ble_gap_update_params */
+    uint32_t exchange_mtu_calls;          /* Calls to ble_gattc_exchange_mtu */
+    int exchange_mtu_rc;                  /* Value returned by ble_gattc_exchange_mtu */
+    uint32_t data_len_calls;              /* Calls to ble_gap_set_data_len */
+    int data_len_rc;                      /* Value returned by ble_gap_set_data_len */
+    uint16_t data_len_tx_octets;          /* Octets asked for by the last ble_gap_set_data_len */
+    uint32_t phy_calls;                   /* Calls to ble_gap_set_prefered_le_phy */
+    int phy_rc;                           /* Value returned by ble_gap_set_prefered_le_phy */
+    uint32_t terminate_calls;             /* Calls to ble_gap_terminate */
+    uint16_t terminate_handle;            /* Connection given to the last ble_gap_terminate */
+    uint8_t terminate_reason;             /* HCI reason given to the last ble_gap_terminate */
+    ble_gap_event_fn *cb;                 /* GAP callback given to the last ble_gap_adv_start */
+    void *cb_arg;                         /* Argument of cb */
+} Stub_Gap;
+
+extern Stub_Notify Stub_Notify_State;
+extern Stub_Gap Stub_Gap_State;
+
+void Stub_Reset(void);
+void Stub_Tick_Advance(TickType_t ticks);
+void Stub_Timers_Stop_All(void);
+void Stub_Host_Run_Queued(void);
+void Stub_Notify_Release_Held(void);
+void Stub_Gap_Set_Conn(uint16_t conn_handle, uint16_t itvl, uint16_t latency, uint16_t timeout);
+void Stub_Gap_Drop_Conn(uint16_t conn_handle);
+struct os_mbuf *Stub_Mbuf_Get(void);
+struct os_mbuf *Stub_Mbuf_Chain(const void *data, uint16_t len, uint16_t segment);
+uint16_t Stub_Mbuf_Free_Count(void);
+void Stub_Log_Output(FILE *out);
+void Stub_Clock_Advance(int64_t us);
+
+#endif /* HOST_STUB_H */
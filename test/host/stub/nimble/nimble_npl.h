@@ -0,0 +1,41 @@
+/* BLE GATT example - host stand-in for the NimBLE porting layer events
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef STUB_NIMBLE_NPL_H
+#define STUB_NIMBLE_NPL_H
+
+#include <stdbool.h> /* This is the standard C lib used for the bool type */
+
+struct ble_npl_event;
+typedef void ble_npl_event_fn(struct ble_npl_event *ev);
+
+/**
+ * @brief Event run by the task draining the queue it is put on
+ */
+struct ble_npl_event
+{
+    bool queued;                /* On a queue, a second put is ignored like in the FreeRTOS port */
+    ble_npl_event_fn *fn;       /* Handler */
+    void *arg;                  /* Argument of the handler */
+    struct ble_npl_event *next; /* Next event on the queue */
+};
+
+/**
+ * @brief Queue of events, drained in order
+ */
+struct ble_npl_eventq
+{
+    struct ble_npl_event *head; /* Next event to run */
+    struct ble_npl_event *tail; /* Last event put */
+};
+
+void ble_npl_event_init(struct ble_npl_event *ev, ble_npl_event_fn *fn, void *arg);
+void *ble_npl_event_get_arg(struct ble_npl_event *ev);
+void ble_npl_eventq_put(struct ble_npl_eventq *evq, struct ble_npl_event *ev);
+
+#endif /* STUB_NIMBLE_NPL_H */
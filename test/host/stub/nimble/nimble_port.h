@@ -0,0 +1,18 @@
+/* BLE GATT example - host stand-in for the NimBLE port
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef STUB_NIMBLE_PORT_H
+#define STUB_NIMBLE_PORT_H
+
+#include "nimble/nimble_npl.h" /* This is the porting layer event stand-in */
+
+void nimble_port_init(void);
+void nimble_port_run(void);
+struct ble_npl_eventq *nimble_port_get_dflt_eventq(void);
+
+#endif /* STUB_NIMBLE_PORT_H */
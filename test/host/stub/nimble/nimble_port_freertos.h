@@ -0,0 +1,18 @@
+/* BLE GATT example - host stand-in for the NimBLE FreeRTOS port
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef STUB_NIMBLE_PORT_FREERTOS_H
+#define STUB_NIMBLE_PORT_FREERTOS_H
+
+#include "freertos/FreeRTOS.h" /* This is the FreeRTOS stand-in types */
+#include "freertos/task.h"     /* This is the task stand-in */
+#include "freertos/timers.h"   /* This is the software timer stand-in */
+
+void nimble_port_freertos_init(TaskFunction_t host_task_fn);
+
+#endif /* STUB_NIMBLE_PORT_FREERTOS_H */
@@ -0,0 +1,97 @@
+/* BLE GATT example - host stand-in for the NimBLE mbufs and mempools
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#ifndef STUB_OS_MBUF_H
+#define STUB_OS_MBUF_H
+
+#include <stddef.h> /* This is the standard C lib used for the size_t type */
+#include <stdint.h> /* This is the standard C lib used for the fixed width integer types */
+
+#define SLIST_ENTRY(type) struct { struct type *sle_next; } /* Same singly linked list link as NimBLE */
+#define SLIST_NEXT(elm, field) ((elm)->field.sle_next)
+#define STAILQ_ENTRY(type) struct { struct type *stqe_next; }
+
+#define OS_ENOMEM 1 /* Pool exhausted */
+#define OS_EINVAL 2 /* Bad argument */
+
+typedef uint64_t os_membuf_t; /* Mempool storage unit, wide enough to align the mbuf pointers on a 64 bit host */
+
+#define OS_ALIGNMENT sizeof(os_membuf_t)                                                  /* Block alignment */
+#define OS_MEMPOOL_SIZE(n, blksize) ((((blksize) + OS_ALIGNMENT - 1) / OS_ALIGNMENT) * (n)) /* Storage units for n blocks */
+
+/**
+ * @brief Free block of a mempool
+ */
+struct os_memblock
+{
+    struct os_memblock *mb_next; /* Next free block */
+};
+
+/**
+ * @brief Fixed-size block allocator, same fields as the NimBLE one the application reads
+ */
+struct os_mempool
+{
+    uint32_t mp_block_size;      /* Size of one block, rounded up to OS_ALIGNMENT */
+    uint16_t mp_num_blocks;      /* Blocks in the pool */
+    uint16_t mp_num_free;        /* Blocks on the free list */
+    uint16_t mp_min_free;        /* Low water mark of the free list */
+    struct os_memblock *mp_head; /* Free list */
+    const char *name;            /* Name of the pool */
+};
+
+/**
+ * @brief Mbuf pool built on a mempool
+ */
+struct os_mbuf_pool
+{
+    uint16_t omp_databuf_len;     /* Data bytes per mbuf */
+    struct os_mempool *omp_pool; /* Blocks backing the mbufs */
+};
+
+/**
+ * @brief Packet header stored at the start of the first mbuf of a chain
+ */
+struct os_mbuf_pkthdr
+{
+    uint16_t omp_len;                         /* Length of the whole chain */
+    uint16_t omp_flags;                       /* Unused */
+    STAILQ_ENTRY(os_mbuf_pkthdr) omp_next; /* Unused */
+};
+
+/**
+ * @brief One buffer of a chain, laid out like the NimBLE mbuf
+ */
+struct os_mbuf
+{
+    uint8_t *om_data;              /* Start of the data in this mbuf */
+    uint8_t om_flags;              /* Unused */
+    uint8_t om_pkthdr_len;         /* Bytes of packet header before the data buffer */
+    uint16_t om_len;               /* Data bytes in this mbuf */
+    struct os_mbuf_pool *om_omp; /* Pool the mbuf came from */
+    SLIST_ENTRY(os_mbuf) om_next; /* Next mbuf of the chain */
+    uint8_t om_databuf[0];         /* Packet header and data */
+};
+
+#define OS_MBUF_PKTHDR(om) ((struct os_mbuf_pkthdr *)(void *)((om)->om_databuf)) /* Packet header of the first mbuf */
+#define OS_MBUF_PKTLEN(om) (OS_MBUF_PKTHDR(om)->omp_len)                         /* Length of the whole chain */
+#define OS_MBUF_DATA(om, type) ((type)((om)->om_data))
+
+int os_mempool_init(struct os_mempool *mp, uint16_t blocks, uint32_t block_size, void *membuf, const char *name);
+void *os_memblock_get(struct os_mempool *mp);
+void os_memblock_put(struct os_mempool *mp, void *block);
+
+int os_mbuf_pool_init(struct os_mbuf_pool *omp, struct os_mempool *mp, uint16_t buf_len, uint16_t nbufs);
+struct os_mbuf *os_mbuf_get(struct os_mbuf_pool *omp, uint16_t leadingspace);
+struct os_mbuf *os_mbuf_get_pkthdr(struct os_mbuf_pool *omp, uint8_t pkthdr_len);
+int os_mbuf_append(struct os_mbuf *om, const void *data, uint16_t len);
+int os_mbuf_copydata(const struct os_mbuf *om, int off, int len, void *dst);
+int os_mbuf_free_chain(struct os_mbuf *om);
+uint16_t os_mbuf_len(const struct os_mbuf *om);
+
+#endif /* STUB_OS_MBUF_H */
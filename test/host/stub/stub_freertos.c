@@ -0,0 +1,271 @@
+/* BLE GATT example - host stand-in for FreeRTOS tasks and software timers
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#define _GNU_SOURCE            /* This is the glibc extensions, for SCHED_IDLE */
+#include <pthread.h>           /* This is the POSIX lib used to run the tasks */
+#include <sched.h>             /* This is the POSIX lib used to run the tasks below the host task */
+#include <stdatomic.h>         /* This is the standard C lib used for the tick counter */
+#include <stdlib.h>            /* This is the standard C lib used for calloc */
+#include <time.h>              /* This is the standard C lib used for nanosleep */
+#include <freertos/FreeRTOS.h> /* This is the FreeRTOS stand-in types */
+#include <freertos/task.h>     /* This is the task stand-in interface */
+#include <freertos/timers.h>   /* This is the software timer stand-in interface */
+#include "host_stub.h"         /* This is the stand-in control interface */
+
+#define STUB_TIMER_MAX 16 /* Timers the application may create */
+
+/**
+ * @brief Task stand-in
+ */
+struct Stub_Task
+{
+    const char *name;      /* Name given at creation */
+    TaskFunction_t fn;     /* Entry point */
+    void *param;           /* Argument of the entry point */
+    pthread_t thread;      /* Thread running the task */
+    pthread_mutex_t lock;  /* Protects notify */
+    pthread_cond_t wake;   /* Signalled by xTaskNotifyGive */
+    uint32_t notify;       /* Notification value */
+};
+
+/**
+ * @brief Software timer stand-in
+ */
+struct Stub_Timer
+{
+    const char *name;                 /* Name given at creation */
+    TickType_t period;                /* Period in ticks */
+    bool reload;                      /* Restart after firing */
+    bool active;                      /* Waiting to fire */
+    TickType_t expiry;                /* Tick the timer fires at */
+    void *id;                         /* Identifier given at creation */
+    TimerCallbackFunction_t callback; /* Function called when the timer fires */
+};
+
+static struct Stub_Task Stub_Host_Task = {"nimble_host", NULL, NULL, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0}; /* The test thread stands in for the NimBLE host task */
+static struct Stub_Task Stub_Timer_Task = {"Tmr Svc", NULL, NULL, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0};     /* Stands in for the timer task */
+static _Thread_local struct Stub_Task *Stub_Current_Task;                                                                          /* Task running on this thread */
+static atomic_uint Stub_Tick_Count;                                                                                                 /* Scheduler ticks since start */
+static struct Stub_Timer Stub_Timers[STUB_TIMER_MAX];                                                                               /* Every timer created */
+static size_t Stub_Timer_Count;                                                                                                     /* Entries used in Stub_Timers */
+
+/**
+ * @brief Thread entry point of a task
+ *
+ * Every task the application creates runs below the NimBLE host task, so
+ * its thread only runs when the others are idle or yield: notifying it must
+ * not switch to it straight away, as FreeRTOS would not.
+ *
+ * @param arg Task to run
+ * @return void* Never returns while the task runs
+ */
+static void *Stub_Task_Thread(void *arg)
+{
+    struct Stub_Task *task = arg;
+    struct sched_param param = {0};
+
+    Stub_Current_Task = task;
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param); /* Below the test thread standing in for the host task */
+    task->fn(task->param);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    struct Stub_Task *task = calloc(1, sizeof(*task));
+
+    if (task == NULL)
+    {
+        return pdFAIL;
+    }
+    task->name = name;
+    task->fn = fn;
+    task->param = param;
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->wake, NULL);
+    if (handle != NULL) /* Publish the handle before the task can look it up */
+    {
+        *handle = task;
+    }
+    if (pthread_create(&task->thread, NULL, Stub_Task_Thread, task) != 0)
+    {
+        return pdFAIL;
+    }
+    pthread_detach(task->thread); /* Tasks never return */
+    return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return Stub_Current_Task != NULL ? Stub_Current_Task : &Stub_Host_Task; /* Threads the stand-ins did not start act as the host task */
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return atomic_load(&Stub_Tick_Count);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec delay = {ticks / configTICK_RATE_HZ, (long)(ticks % configTICK_RATE_HZ) * (1000000000L / configTICK_RATE_HZ)};
+
+    nanosleep(&delay, NULL); /* Real time, the simulated tick count is left alone */
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    struct Stub_Task *task = xTaskGetCurrentTaskHandle();
+    uint32_t value;
+
+    pthread_mutex_lock(&task->lock);
+    while (task->notify == 0 && ticks_to_wait == portMAX_DELAY) /* Only blocking forever is needed by the application */
+    {
+        pthread_cond_wait(&task->wake, &task->lock);
+    }
+    value = task->notify;
+    if (value != 0)
+    {
+        task->notify = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_signal(&task->wake);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload, void *id, TimerCallbackFunction_t callback)
+{
+    if (Stub_Timer_Count == STUB_TIMER_MAX || period == 0)
+    {
+        return NULL;
+    }
+
+    struct Stub_Timer *timer = &Stub_Timers[Stub_Timer_Count++];
+    timer->name = name;
+    timer->period = period;
+    timer->reload = auto_reload != pdFALSE;
+    timer->active = false;
+    timer->id = id;
+    timer->callback = callback;
+    return timer;
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks_to_wait)
+{
+    timer->expiry = xTaskGetTickCount() + timer->period; /* Same as FreeRTOS: the period counts from the call */
+    timer->active = true;
+    return pdPASS;
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks_to_wait)
+{
+    timer->active = false;
+    return pdPASS;
+}
+
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticks_to_wait)
+{
+    return xTimerStart(timer, ticks_to_wait);
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks_to_wait)
+{
+    if (period == 0)
+    {
+        return pdFAIL;
+    }
+    timer->period = period;
+    return xTimerStart(timer, ticks_to_wait); /* Changing the period also starts the timer */
+}
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer)
+{
+    return timer->active ? pdTRUE : pdFALSE;
+}
+
+TaskHandle_t xTimerGetTimerDaemonTaskHandle(void)
+{
+    return &Stub_Timer_Task;
+}
+
+/**
+ * @brief Advance the scheduler and fire the timers that expire
+ *
+ * Jumps from one expiry to the next, so idle ticks cost nothing. Timers due
+ * on the same tick fire in creation order on the calling thread, which
+ * stands in for the timer task while they run; the events they posted to the
+ * host task are then run before the next expiry.
+ *
+ * @param ticks Ticks to advance
+ */
+void Stub_Tick_Advance(TickType_t ticks)
+{
+    struct Stub_Task *caller = Stub_Current_Task;
+    TickType_t now = xTaskGetTickCount();
+    TickType_t left = ticks;
+
+    while (left > 0)
+    {
+        TickType_t step = left; /* Ticks to the next expiry, or to the end */
+
+        for (size_t t = 0; t < Stub_Timer_Count; t++)
+        {
+            TickType_t due = Stub_Timers[t].expiry - now; /* Timers are never more than a period ahead, so this cannot wrap */
+
+            if (Stub_Timers[t].active && due < step)
+            {
+                step = due;
+            }
+        }
+        step = step > 0 ? step : 1;
+        now += step;
+        left -= step;
+        atomic_store(&Stub_Tick_Count, now);
+
+        Stub_Current_Task = &Stub_Timer_Task;
+        for (size_t t = 0; t < Stub_Timer_Count; t++)
+        {
+            struct Stub_Timer *timer = &Stub_Timers[t];
+
+            if (!timer->active || timer->expiry != now) /* Not due this tick */
+            {
+                continue;
+            }
+            if (timer->reload)
+            {
+                timer->expiry = now + timer->period;
+            }
+            else
+            {
+                timer->active = false;
+            }
+            timer->callback(timer);
+        }
+        Stub_Current_Task = caller;
+        Stub_Host_Run_Queued(); /* The host task handles what the timers posted */
+    }
+}
+
+/**
+ * @brief Stop every timer
+ */
+void Stub_Timers_Stop_All(void)
+{
+    for (size_t t = 0; t < Stub_Timer_Count; t++)
+    {
+        Stub_Timers[t].active = false;
+    }
+}
@@ -0,0 +1,686 @@
+/* BLE GATT example - host stand-in for the NimBLE host and the ESP libraries
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <pthread.h>            /* This is the POSIX lib used to guard the event queue */
+#include <stdarg.h>             /* This is the standard C lib used for the log arguments */
+#include <stdatomic.h>          /* This is the standard C lib used for the clock offset */
+#include <string.h>             /* This is the standard C lib used for memcpy */
+#include <time.h>               /* This is the standard C lib used for the monotonic clock */
+#include <esp_log.h>            /* This is the logging stand-in interface */
+#include <esp_timer.h>          /* This is the high resolution timer stand-in interface */
+#include <host/ble_hs.h>        /* This is the NimBLE host stand-in interface */
+#include <nimble/nimble_port.h> /* This is the NimBLE port stand-in interface */
+#include "host_stub.h"          /* This is the stand-in control interface */
+
+#define STUB_MSYS_BLOCK_COUNT 64                                    /* Buffers available to the tests for access contexts */
+#define STUB_MSYS_BLOCK_DATA_SIZE 600                               /* Data bytes per buffer, enough for any attribute value */
+#define STUB_MSYS_BLOCK_SIZE (sizeof(struct os_mbuf) + STUB_MSYS_BLOCK_DATA_SIZE) /* Size of one mempool block */
+#define STUB_CONN_MAX 8                                             /* Connections ble_gap_conn_find can know about */
+
+Stub_Notify Stub_Notify_State; /* Notifications handed to the host */
+Stub_Gap Stub_Gap_State;       /* GAP procedures started */
+struct ble_hs_cfg ble_hs_cfg;  /* Host configuration set by app_main */
+
+static os_membuf_t Stub_Msys_Memory[OS_MEMPOOL_SIZE(STUB_MSYS_BLOCK_COUNT, STUB_MSYS_BLOCK_SIZE)]; /* Storage of the test buffers */
+static struct os_mempool Stub_Msys_Mempool;                                                     /* Blocks of the test buffers */
+static struct os_mbuf_pool Stub_Msys_Pool;                                                      /* Test buffers, like the NimBLE msys pool */
+static struct ble_gap_conn_desc Stub_Conns[STUB_CONN_MAX];                                      /* Connections known to ble_gap_conn_find */
+static bool Stub_Conn_Used[STUB_CONN_MAX];                                                      /* Entries used in Stub_Conns */
+static uint16_t Stub_Next_Handle = 1;                                                           /* Next attribute handle given out by ble_gatts_add_svcs */
+static struct ble_npl_eventq Stub_Dflt_Eventq;                                                 /* Default event queue of the host task */
+static pthread_mutex_t Stub_Eventq_Lock = PTHREAD_MUTEX_INITIALIZER;                            /* Guards Stub_Dflt_Eventq, put from any task */
+static FILE *Stub_Log_Stream;                                                                   /* Where esp_log_write prints, NULL for stdout */
+static bool Stub_Log_Silent;                                                                    /* Drop every log line */
+static atomic_llong Stub_Clock_Offset_Us;                                                       /* Added to the monotonic clock by esp_timer_get_time */
+
+/* Mempool */
+
+int os_mempool_init(struct os_mempool *mp, uint16_t blocks, uint32_t block_size, void *membuf, const char *name)
+{
+    uint32_t size = (block_size + OS_ALIGNMENT - 1) / OS_ALIGNMENT * OS_ALIGNMENT; /* Keep every block aligned */
+    uint8_t *block = membuf;
+
+    mp->mp_block_size = size;
+    mp->mp_num_blocks = blocks;
+    mp->mp_num_free = blocks;
+    mp->mp_min_free = blocks;
+    mp->mp_head = NULL;
+    mp->name = name;
+    for (uint16_t i = blocks; i > 0; i--) /* Build the free list in address order */
+    {
+        struct os_memblock *free_block = (struct os_memblock *)(void *)(block + (size_t)(i - 1) * size);
+        free_block->mb_next = mp->mp_head;
+        mp->mp_head = free_block;
+    }
+    return 0;
+}
+
+void *os_memblock_get(struct os_mempool *mp)
+{
+    struct os_memblock *block = mp->mp_head;
+
+    if (block == NULL) /* Pool exhausted */
+    {
+        return NULL;
+    }
+    mp->mp_head = block->mb_next;
+    mp->mp_num_free--;
+    if (mp->mp_num_free < mp->mp_min_free)
+    {
+        mp->mp_min_free = mp->mp_num_free;
+    }
+    return block;
+}
+
+void os_memblock_put(struct os_mempool *mp, void *block)
+{
+    struct os_memblock *free_block = block;
+
+    free_block->mb_next = mp->mp_head;
+    mp->mp_head = free_block;
+    mp->mp_num_free++;
+}
+
+/* Mbufs */
+
+int os_mbuf_pool_init(struct os_mbuf_pool *omp, struct os_mempool *mp, uint16_t buf_len, uint16_t nbufs)
+{
+    omp->omp_databuf_len = buf_len - sizeof(struct os_mbuf); /* Same as NimBLE: the block holds the header and the data */
+    omp->omp_pool = mp;
+    return 0;
+}
+
+struct os_mbuf *os_mbuf_get(struct os_mbuf_pool *omp, uint16_t leadingspace)
+{
+    struct os_mbuf *om = os_memblock_get(omp->omp_pool);
+
+    if (om == NULL)
+    {
+        return NULL;
+    }
+    memset(om, 0, sizeof(*om));
+    om->om_omp = omp;
+    om->om_data = om->om_databuf + leadingspace;
+    return om;
+}
+
+struct os_mbuf *os_mbuf_get_pkthdr(struct os_mbuf_pool *omp, uint8_t pkthdr_len)
+{
+    uint16_t hdr_len = sizeof(struct os_mbuf_pkthdr) + pkthdr_len;
+    struct os_mbuf *om = os_mbuf_get(omp, hdr_len);
+
+    if (om == NULL)
+    {
+        return NULL;
+    }
+    om->om_pkthdr_len = hdr_len;
+    memset(OS_MBUF_PKTHDR(om), 0, sizeof(struct os_mbuf_pkthdr));
+    return om;
+}
+
+int os_mbuf_append(struct os_mbuf *om, const void *data, uint16_t len)
+{
+    const uint8_t *src = data;
+    struct os_mbuf *last = om;
+
+    while (SLIST_NEXT(last, om_next) != NULL) /* Append after the last mbuf of the chain */
+    {
+        last = SLIST_NEXT(last, om_next);
+    }
+
+    while (len > 0)
+    {
+        uint16_t space = (uint16_t)(last->om_databuf + om->om_omp->omp_databuf_len - (last->om_data + last->om_len)); /* Trailing space */
+
+        if (space == 0) /* Chain another mbuf from the same pool */
+        {
+            struct os_mbuf *next = os_mbuf_get(om->om_omp, 0);
+            if (next == NULL)
+            {
+                return OS_ENOMEM;
+            }
+            SLIST_NEXT(last, om_next) = next;
+            last = next;
+            continue;
+        }
+
+        uint16_t chunk = len < space ? len : space;
+        memcpy(last->om_data + last->om_len, src, chunk);
+        last->om_len += chunk;
+        src += chunk;
+        len -= chunk;
+        if (om->om_pkthdr_len != 0)
+        {
+            OS_MBUF_PKTLEN(om) += chunk;
+        }
+    }
+    return 0;
+}
+
+int os_mbuf_copydata(const struct os_mbuf *om, int off, int len, void *dst)
+{
+    uint8_t *out = dst;
+
+    for (; om != NULL && len > 0; om = SLIST_NEXT(om, om_next))
+    {
+        if (off >= om->om_len) /* Skip whole mbufs before the offset */
+        {
+            off -= om->om_len;
+            continue;
+        }
+        int chunk = om->om_len - off < len ? om->om_len - off : len;
+        memcpy(out, om->om_data + off, chunk);
+        out += chunk;
+        len -= chunk;
+        off = 0;
+    }
+    return len == 0 ? 0 : -1;
+}
+
+int os_mbuf_free_chain(struct os_mbuf *om)
+{
+    while (om != NULL)
+    {
+        struct os_mbuf *next = SLIST_NEXT(om, om_next);
+        os_memblock_put(om->om_omp->omp_pool, om);
+        om = next;
+    }
+    return 0;
+}
+
+uint16_t os_mbuf_len(const struct os_mbuf *om)
+{
+    uint16_t len = 0;
+
+    for (; om != NULL; om = SLIST_NEXT(om, om_next))
+    {
+        len += om->om_len;
+    }
+    return len;
+}
+
+int ble_hs_mbuf_to_flat(const struct os_mbuf *om, void *flat, uint16_t max_len, uint16_t *out_copy_len)
+{
+    uint16_t len = os_mbuf_len(om);
+    uint16_t copy = len < max_len ? len : max_len;
+
+    os_mbuf_copydata(om, 0, copy, flat);
+    if (out_copy_len != NULL)
+    {
+        *out_copy_len = copy;
+    }
+    return len > max_len ? BLE_HS_EMSGSIZE : 0;
+}
+
+/* Porting layer events */
+
+void ble_npl_event_init(struct ble_npl_event *ev, ble_npl_event_fn *fn, void *arg)
+{
+    ev->queued = false;
+    ev->fn = fn;
+    ev->arg = arg;
+    ev->next = NULL;
+}
+
+void *ble_npl_event_get_arg(struct ble_npl_event *ev)
+{
+    return ev->arg;
+}
+
+void ble_npl_eventq_put(struct ble_npl_eventq *evq, struct ble_npl_event *ev)
+{
+    pthread_mutex_lock(&Stub_Eventq_Lock);
+    if (!ev->queued) /* Already queued events are not queued twice */
+    {
+        ev->queued = true;
+        ev->next = NULL;
+        if (evq->tail != NULL)
+        {
+            evq->tail->next = ev;
+        }
+        else
+        {
+            evq->head = ev;
+        }
+        evq->tail = ev;
+    }
+    pthread_mutex_unlock(&Stub_Eventq_Lock);
+}
+
+struct ble_npl_eventq *nimble_port_get_dflt_eventq(void)
+{
+    return &Stub_Dflt_Eventq;
+}
+
+/**
+ * @brief Run every event queued for the host task, on the calling thread
+ */
+void Stub_Host_Run_Queued(void)
+{
+    for (;;)
+    {
+        pthread_mutex_lock(&Stub_Eventq_Lock);
+        struct ble_npl_event *ev = Stub_Dflt_Eventq.head;
+        if (ev != NULL) /* Take the event off the queue before running it, so it can be put again */
+        {
+            Stub_Dflt_Eventq.head = ev->next;
+            if (Stub_Dflt_Eventq.head == NULL)
+            {
+                Stub_Dflt_Eventq.tail = NULL;
+            }
+            ev->queued = false;
+        }
+        pthread_mutex_unlock(&Stub_Eventq_Lock);
+
+        if (ev == NULL)
+        {
+            return;
+        }
+        ev->fn(ev);
+    }
+}
+
+/* GATT */
+
+int ble_gatts_count_cfg(const struct ble_gatt_svc_def *defs)
+{
+    return 0;
+}
+
+int ble_gatts_add_svcs(const struct ble_gatt_svc_def *svcs)
+{
+    for (; svcs->type != BLE_GATT_SVC_TYPE_END; svcs++) /* Number the attributes the way the host lays them out */
+    {
+        Stub_Next_Handle++; /* Service declaration */
+        for (const struct ble_gatt_chr_def *chr = svcs->characteristics; chr != NULL && chr->uuid != NULL; chr++)
+        {
+            Stub_Next_Handle++; /* Characteristic declaration */
+            if (chr->val_handle != NULL)
+            {
+                *chr->val_handle = Stub_Next_Handle;
+            }
+            Stub_Next_Handle++; /* Characteristic value */
+            for (const struct ble_gatt_dsc_def *dsc = chr->descriptors; dsc != NULL && dsc->uuid != NULL; dsc++)
+            {
+                Stub_Next_Handle++; /* Descriptor */
+            }
+        }
+    }
+    return 0;
+}
+
+int ble_gattc_notify_custom(uint16_t conn_handle, uint16_t att_handle, struct os_mbuf *om)
+{
+    Stub_Notify *notify = &Stub_Notify_State;
+    uint16_t len = os_mbuf_len(om);
+    int rc = notify->rc;
+
+    if (rc == 0)
+    {
+        notify->count++;
+        notify->bytes += len;
+        notify->last_conn = conn_handle;
+        notify->last_handle = att_handle;
+        notify->last_len = len;
+        os_mbuf_copydata(om, 0, len < sizeof(notify->last_data) ? len : sizeof(notify->last_data), notify->last_data);
+        if (notify->hook != NULL)
+        {
+            notify->hook(conn_handle, att_handle, notify->last_data, len, notify->hook_arg);
+        }
+    }
+
+    if (rc == 0 && notify->hold && notify->held_count < STUB_NOTIFY_MAX_HELD) /* Leave the buffer in the controller */
+    {
+        notify->held[notify->held_count++] = om;
+    }
+    else /* The buffer is consumed either way */
+    {
+        os_mbuf_free_chain(om);
+    }
+
+    if (Stub_Gap_State.cb != NULL) /* The host reports the transmission to the connection's GAP callback */
+    {
+        struct ble_gap_event event = {.type = BLE_GAP_EVENT_NOTIFY_TX};
+        event.notify_tx.status = rc;
+        event.notify_tx.conn_handle = conn_handle;
+        event.notify_tx.attr_handle = att_handle;
+        Stub_Gap_State.cb(&event, Stub_Gap_State.cb_arg);
+    }
+    return rc;
+}
+
+int ble_gattc_exchange_mtu(uint16_t conn_handle, void *cb, void *cb_arg)
+{
+    Stub_Gap_State.exchange_mtu_calls++;
+    return Stub_Gap_State.exchange_mtu_rc;
+}
+
+/* GAP */
+
+int ble_hs_id_infer_auto(int privacy, uint8_t *out_addr_type)
+{
+    *out_addr_type = 0; /* Public address */
+    return 0;
+}
+
+int ble_gap_adv_set_data(const uint8_t *data, int data_len)
+{
+    memcpy(Stub_Gap_State.adv_data, data, data_len);
+    Stub_Gap_State.adv_data_len = data_len;
+    return 0;
+}
+
+int ble_gap_adv_rsp_set_data(const uint8_t *data, int data_len)
+{
+    return 0;
+}
+
+int ble_gap_adv_start(uint8_t own_addr_type, const void *direct_addr, int32_t duration_ms,
+                      const struct ble_gap_adv_params *adv_params, ble_gap_event_fn *cb, void *cb_arg)
+{
+    if (Stub_Gap_State.adv_active)
+    {
+        return BLE_HS_EALREADY;
+    }
+    Stub_Gap_State.adv_starts++;
+    Stub_Gap_State.adv_duration_ms = duration_ms;
+    Stub_Gap_State.adv_params = *adv_params;
+    Stub_Gap_State.adv_active = true;
+    Stub_Gap_State.cb = cb;
+    Stub_Gap_State.cb_arg = cb_arg;
+    return 0;
+}
+
+int ble_gap_adv_stop(void)
+{
+    Stub_Gap_State.adv_active = false;
+    return 0;
+}
+
+int ble_gap_adv_active(void)
+{
+    return Stub_Gap_State.adv_active;
+}
+
+int ble_gap_update_params(uint16_t conn_handle, const struct ble_gap_upd_params *params)
+{
+    Stub_Gap_State.update_params_calls++;
+    return Stub_Gap_State.update_params_rc;
+}
+
+int ble_gap_set_prefered_le_phy(uint16_t conn_handle, uint8_t tx_phys_mask, uint8_t rx_phys_mask, uint16_t phy_opts)
+{
+    Stub_Gap_State.phy_calls++;
+    return Stub_Gap_State.phy_rc;
+}
+
+int ble_gap_set_data_len(uint16_t conn_handle, uint16_t tx_octets, uint16_t tx_time)
+{
+    Stub_Gap_State.data_len_calls++;
+    Stub_Gap_State.data_len_tx_octets = tx_octets;
+    return Stub_Gap_State.data_len_rc;
+}
+
+int ble_gap_terminate(uint16_t conn_handle, uint8_t hci_reason)
+{
+    Stub_Gap_State.terminate_calls++;
+    Stub_Gap_State.terminate_handle = conn_handle;
+    Stub_Gap_State.terminate_reason = hci_reason;
+    return 0;
+}
+
+int ble_gap_conn_find(uint16_t conn_handle, struct ble_gap_conn_desc *out_desc)
+{
+    for (size_t i = 0; i < STUB_CONN_MAX; i++)
+    {
+        if (Stub_Conn_Used[i] && Stub_Conns[i].conn_handle == conn_handle)
+        {
+            *out_desc = Stub_Conns[i];
+            return 0;
+        }
+    }
+    return BLE_HS_ENOTCONN;
+}
+
+/**
+ * @brief Append one AD structure to an advertising payload
+ *
+ * @return int 0 on success, BLE_HS_EMSGSIZE if it does not fit
+ */
+static int Stub_Adv_Put(uint8_t *dst, uint8_t *dst_len, uint8_t max_len, uint8_t type, const void *data, uint8_t len)
+{
+    if (*dst_len + 2 + len > max_len)
+    {
+        return BLE_HS_EMSGSIZE;
+    }
+    dst[(*dst_len)++] = len + 1;
+    dst[(*dst_len)++] = type;
+    memcpy(dst + *dst_len, data, len);
+    *dst_len += len;
+    return 0;
+}
+
+int ble_hs_adv_set_fields(const struct ble_hs_adv_fields *adv_fields, uint8_t *dst, uint8_t *dst_len, uint8_t max_len)
+{
+    int rc = 0;
+
+    *dst_len = 0;
+    if (adv_fields->flags != 0)
+    {
+        rc |= Stub_Adv_Put(dst, dst_len, max_len, 0x01, &adv_fields->flags, 1);
+    }
+    for (uint8_t i = 0; i < adv_fields->num_uuids128; i++)
+    {
+        rc |= Stub_Adv_Put(dst, dst_len, max_len, adv_fields->uuids128_is_complete ? 0x07 : 0x06, adv_fields->uuids128[i].value, 16);
+    }
+    if (adv_fields->tx_pwr_lvl_is_present)
+    {
+        int8_t level = adv_fields->tx_pwr_lvl == BLE_HS_ADV_TX_PWR_LVL_AUTO ? 0 : adv_fields->tx_pwr_lvl;
+        rc |= Stub_Adv_Put(dst, dst_len, max_len, 0x0a, &level, 1);
+    }
+    if (adv_fields->name != NULL)
+    {
+        rc |= Stub_Adv_Put(dst, dst_len, max_len, adv_fields->name_is_complete ? 0x09 : 0x08, adv_fields->name, adv_fields->name_len);
+    }
+    return rc != 0 ? BLE_HS_EMSGSIZE : 0;
+}
+
+/* ESP libraries */
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000 + atomic_load(&Stub_Clock_Offset_Us);
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    va_list args;
+
+    if (Stub_Log_Silent)
+    {
+        return;
+    }
+    va_start(args, format);
+    vfprintf(Stub_Log_Stream != NULL ? Stub_Log_Stream : stdout, format, args);
+    va_end(args);
+}
+
+/* Control */
+
+/**
+ * @brief Forget every notification, GAP procedure and connection recorded
+ */
+void Stub_Reset(void)
+{
+    Stub_Notify_Release_Held();
+    memset(&Stub_Notify_State, 0, sizeof(Stub_Notify_State));
+    memset(&Stub_Gap_State, 0, sizeof(Stub_Gap_State));
+    memset(Stub_Conn_Used, 0, sizeof(Stub_Conn_Used));
+    Stub_Timers_Stop_All();
+}
+
+/**
+ * @brief Let the controller send every notification kept by hold
+ */
+void Stub_Notify_Release_Held(void)
+{
+    for (uint32_t i = 0; i < Stub_Notify_State.held_count; i++)
+    {
+        os_mbuf_free_chain(Stub_Notify_State.held[i]);
+    }
+    Stub_Notify_State.held_count = 0;
+}
+
+/**
+ * @brief Set the parameters ble_gap_conn_find reports for a connection
+ *
+ * @param conn_handle Connection handle
+ * @param itvl Connection interval in 1.25 ms units
+ * @param latency Peripheral latency in connection events
+ * @param timeout Supervision timeout in 10 ms units
+ */
+void Stub_Gap_Set_Conn(uint16_t conn_handle, uint16_t itvl, uint16_t latency, uint16_t timeout)
+{
+    size_t slot = STUB_CONN_MAX;
+
+    for (size_t i = 0; i < STUB_CONN_MAX; i++) /* Update the entry of the handle, or take a free one */
+    {
+        if (Stub_Conn_Used[i] && Stub_Conns[i].conn_handle == conn_handle)
+        {
+            slot = i;
+            break;
+        }
+        if (!Stub_Conn_Used[i] && slot == STUB_CONN_MAX)
+        {
+            slot = i;
+        }
+    }
+    if (slot == STUB_CONN_MAX)
+    {
+        return;
+    }
+    Stub_Conns[slot] = (struct ble_gap_conn_desc){conn_handle, itvl, latency, timeout};
+    Stub_Conn_Used[slot] = true;
+}
+
+/**
+ * @brief Make ble_gap_conn_find forget a connection
+ *
+ * @param conn_handle Connection handle
+ */
+void Stub_Gap_Drop_Conn(uint16_t conn_handle)
+{
+    for (size_t i = 0; i < STUB_CONN_MAX; i++)
+    {
+        if (Stub_Conn_Used[i] && Stub_Conns[i].conn_handle == conn_handle)
+        {
+            Stub_Conn_Used[i] = false;
+        }
+    }
+}
+
+/**
+ * @brief Take an empty buffer, as the host hands to a read access callback
+ *
+ * @return struct os_mbuf* Empty packet header mbuf, free it with os_mbuf_free_chain
+ */
+struct os_mbuf *Stub_Mbuf_Get(void)
+{
+    if (Stub_Msys_Pool.omp_pool == NULL) /* First use */
+    {
+        os_mempool_init(&Stub_Msys_Mempool, STUB_MSYS_BLOCK_COUNT, STUB_MSYS_BLOCK_SIZE, Stub_Msys_Memory, "stub_msys");
+        os_mbuf_pool_init(&Stub_Msys_Pool, &Stub_Msys_Mempool, STUB_MSYS_BLOCK_SIZE, STUB_MSYS_BLOCK_COUNT);
+    }
+    return os_mbuf_get_pkthdr(&Stub_Msys_Pool, 0);
+}
+
+/**
+ * @brief Build a written value as a chain of mbufs, as the host hands to a write access callback
+ *
+ * @param data Value
+ * @param len Length of the value
+ * @param segment Bytes per mbuf, 0 for a single mbuf
+ * @return struct os_mbuf* Chain holding the value, NULL if the test buffers ran out
+ */
+struct os_mbuf *Stub_Mbuf_Chain(const void *data, uint16_t len, uint16_t segment)
+{
+    const uint8_t *src = data;
+    struct os_mbuf *head = Stub_Mbuf_Get();
+    struct os_mbuf *last = head;
+
+    if (head == NULL)
+    {
+        return NULL;
+    }
+    if (segment == 0)
+    {
+        segment = len;
+    }
+
+    for (uint16_t off = 0; off < len; off += segment)
+    {
+        uint16_t chunk = len - off < segment ? len - off : segment;
+
+        if (off != 0) /* Every segment after the first gets its own mbuf */
+        {
+            struct os_mbuf *next = os_mbuf_get(&Stub_Msys_Pool, 0);
+            if (next == NULL)
+            {
+                os_mbuf_free_chain(head);
+                return NULL;
+            }
+            SLIST_NEXT(last, om_next) = next;
+            last = next;
+        }
+        memcpy(last->om_data, src + off, chunk);
+        last->om_len = chunk;
+        OS_MBUF_PKTLEN(head) += chunk;
+    }
+    return head;
+}
+
+/**
+ * @brief Test buffers left
+ *
+ * @return uint16_t Free blocks of the test buffer pool
+ */
+uint16_t Stub_Mbuf_Free_Count(void)
+{
+    return Stub_Msys_Mempool.mp_num_free;
+}
+
+/**
+ * @brief Choose where the log lines go
+ *
+ * @param out Stream to print to, NULL to drop every line
+ */
+void Stub_Log_Output(FILE *out)
+{
+    Stub_Log_Stream = out;
+    Stub_Log_Silent = out == NULL;
+}
+
+/**
+ * @brief Move esp_timer_get_time forward without waiting
+ *
+ * The FreeRTOS tick count is not affected, see Stub_Tick_Advance for that.
+ *
+ * @param us Microseconds to add
+ */
+void Stub_Clock_Advance(int64_t us)
+{
+    atomic_fetch_add(&Stub_Clock_Offset_Us, us);
+}
@@ -0,0 +1,225 @@
+/* BLE GATT example - adaptive advertising scheduler tests
+
+   Drives the scheduler on a simulated millisecond clock, ending each fast
+   run the way the controller's advertising complete event does, and checks
+   the fast burst, the back-off to the slow interval and the reconnect
+   latencies, with the clock starting at zero and just before the 32-bit
+   wrap. The application's GAP handling is then run across the wrap with the
+   esp_timer clock moved forward.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <esp_timer.h>   /* This is the high resolution timer stand-in, the application's clock */
+#include "host_test.h"   /* This is the test helpers */
+#include "host_app.h"    /* This is the application bring-up */
+#include "host_stub.h"   /* This is the stand-in control interface */
+#include "adv_sched.h"   /* This is the scheduler under test */
+#include "gap_svr.h"     /* This is the GAP event handling */
+#include "gatt_svr.h"    /* This is the GATT services, for the diagnostics read */
+#include "diag.h"        /* This is the runtime performance counters, for the reconnect latency */
+
+#define CLOCK_WRAP_MS 0x100000000LL /* Period of a 32-bit millisecond clock */
+
+/**
+ * @brief Advertise as BLE_app_advertise and the controller do, until the scheduler settles on the slow interval
+ *
+ * Each fast run is let run to its end, where the advertising complete event
+ * asks the scheduler again.
+ *
+ * @param sched Scheduler state
+ * @param now Simulated clock, moved to the end of the fast runs
+ * @param runs Out: advertising runs started
+ * @return uint32_t Time spent advertising fast
+ */
+static uint32_t Run_Until_Slow(Adv_Sched *sched, uint32_t *now, uint32_t *runs)
+{
+    Adv_Sched_Params params;
+    uint32_t fast_ms = 0;
+
+    *runs = 0;
+    for (;;)
+    {
+        Adv_Sched_Next(sched, *now, &params);
+        (*runs)++;
+        if (!params.fast)
+        {
+            CHECK_EQ(params.itvl_min_ms, ADV_SCHED_SLOW_ITVL_MIN_MS);
+            CHECK_EQ(params.itvl_max_ms, ADV_SCHED_SLOW_ITVL_MAX_MS);
+            CHECK_EQ(params.duration_ms, ADV_SCHED_FOREVER);
+            return fast_ms;
+        }
+
+        CHECK_EQ(params.itvl_min_ms, ADV_SCHED_FAST_ITVL_MIN_MS);
+        CHECK_EQ(params.itvl_max_ms, ADV_SCHED_FAST_ITVL_MAX_MS);
+        CHECK(params.duration_ms > 0 && params.duration_ms <= ADV_SCHED_FAST_WINDOW_MS);
+        CHECK(*runs < 10);
+        *now += params.duration_ms; /* The run completes */
+        fast_ms += params.duration_ms;
+    }
+}
+
+/**
+ * @brief Burst, back-off and reconnects with the clock starting at a given time
+ *
+ * @param start Simulated time of boot
+ */
+static void Test_Burst_Back_Off(uint32_t start)
+{
+    Adv_Sched sched;
+    Adv_Sched_Params params;
+    uint32_t now = start;
+    uint32_t runs;
+
+    Adv_Sched_Init(&sched, now); /* Boot: one fast run for the whole window, then slow */
+    CHECK_EQ(Run_Until_Slow(&sched, &now, &runs), ADV_SCHED_FAST_WINDOW_MS);
+    CHECK_EQ(runs, 2);
+    CHECK_EQ(now - start, ADV_SCHED_FAST_WINDOW_MS);
+    now += 3600000; /* Still slow an hour later */
+    Adv_Sched_Next(&sched, now, &params);
+    CHECK(!params.fast);
+
+    CHECK(!Adv_Sched_On_Connect(&sched, now)); /* First connection since boot, nothing to measure */
+    CHECK_EQ(sched.reconnect.count, 0);
+
+    Adv_Sched_On_Disconnect(&sched, now); /* Disconnect: fast again */
+    uint32_t disconnect = now;
+    now += 10000;
+    Adv_Sched_Next(&sched, now, &params); /* Restarted a third of the way in, only the rest is fast */
+    CHECK(params.fast);
+    CHECK_EQ(params.duration_ms, ADV_SCHED_FAST_WINDOW_MS - 10000);
+    CHECK_EQ(Run_Until_Slow(&sched, &now, &runs), ADV_SCHED_FAST_WINDOW_MS - 10000);
+    CHECK_EQ(now - disconnect, ADV_SCHED_FAST_WINDOW_MS);
+
+    now += 15000; /* A central comes back after the back-off */
+    CHECK(Adv_Sched_On_Connect(&sched, now));
+    CHECK_EQ(sched.reconnect.last_ms, ADV_SCHED_FAST_WINDOW_MS + 15000);
+
+    Adv_Sched_On_Disconnect(&sched, now); /* And again, inside the burst */
+    now += 500;
+    CHECK(Adv_Sched_On_Connect(&sched, now));
+    Adv_Sched_Next(&sched, now, &params); /* Further slots are advertised slowly */
+    CHECK(!params.fast);
+
+    Adv_Sched_On_Disconnect(&sched, now);
+    now += 1;
+    CHECK(Adv_Sched_On_Connect(&sched, now));
+    CHECK(!Adv_Sched_On_Connect(&sched, now + 1000)); /* A second slot, no disconnect in between */
+
+    CHECK_EQ(sched.reconnect.count, 3);
+    CHECK_EQ(sched.reconnect.last_ms, 1);
+    CHECK_EQ(sched.reconnect.min_ms, 1);
+    CHECK_EQ(sched.reconnect.max_ms, ADV_SCHED_FAST_WINDOW_MS + 15000);
+    CHECK_EQ(sched.reconnect.total_ms, ADV_SCHED_FAST_WINDOW_MS + 15000 + 500 + 1);
+}
+
+/**
+ * @brief Step the clock a second at a time across the wrap and check the burst ends on time
+ */
+static void Test_Wrap_Stepping(void)
+{
+    Adv_Sched sched;
+    Adv_Sched_Params params;
+    uint32_t disconnect = UINT32_MAX - 12345;
+    uint32_t fast_seconds = 0;
+
+    Adv_Sched_Init(&sched, disconnect - 100000);
+    Adv_Sched_On_Disconnect(&sched, disconnect);
+    for (uint32_t second = 0; second < 60; second++)
+    {
+        Adv_Sched_Next(&sched, disconnect + second * 1000, &params);
+        CHECK_EQ(params.fast, second < ADV_SCHED_FAST_WINDOW_MS / 1000);
+        if (params.fast)
+        {
+            CHECK_EQ(params.duration_ms, ADV_SCHED_FAST_WINDOW_MS - second * 1000);
+            fast_seconds++;
+        }
+    }
+    CHECK_EQ(fast_seconds, ADV_SCHED_FAST_WINDOW_MS / 1000);
+
+    CHECK(Adv_Sched_On_Connect(&sched, disconnect + 20000)); /* Measured across the wrap */
+    CHECK_EQ(sched.reconnect.last_ms, 20000);
+}
+
+/**
+ * @brief Read a little endian 32-bit value
+ */
+static uint32_t Get_U32(const uint8_t *src)
+{
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+/**
+ * @brief Send an advertising complete event to the application
+ */
+static void Adv_Complete(void)
+{
+    struct ble_gap_event event = {.type = BLE_GAP_EVENT_ADV_COMPLETE};
+
+    Stub_Gap_State.adv_active = false;
+    BLE_gap_event(&event, NULL);
+}
+
+/**
+ * @brief Check the application is advertising fast for about a full burst
+ */
+static void Check_Fast_Run(int32_t expected_ms)
+{
+    CHECK(Stub_Gap_State.adv_active);
+    CHECK_EQ(Stub_Gap_State.adv_params.itvl_min, BLE_GAP_ADV_ITVL_MS(ADV_SCHED_FAST_ITVL_MIN_MS));
+    CHECK_EQ(Stub_Gap_State.adv_params.itvl_max, BLE_GAP_ADV_ITVL_MS(ADV_SCHED_FAST_ITVL_MAX_MS));
+    CHECK(Stub_Gap_State.adv_duration_ms <= expected_ms && Stub_Gap_State.adv_duration_ms >= expected_ms - 20); /* The real clock moves a little too */
+}
+
+static void Test_App_Across_Wrap(void)
+{
+    uint8_t snapshot[DIAG_SNAPSHOT_MAX_SIZE];
+    uint16_t len = sizeof(snapshot);
+    const size_t reconnect_offset = 2 + DIAG_COUNTER_COUNT * 4; /* Reconnect part of the snapshot */
+    int64_t now_ms = esp_timer_get_time() / 1000;
+
+    Stub_Clock_Advance((CLOCK_WRAP_MS - 45000 - now_ms % CLOCK_WRAP_MS) * 1000); /* Boot 45 s before the application's clock wraps */
+    Host_App_Start(NULL, NULL);
+    CHECK_EQ(Stub_Gap_State.adv_starts, 1);
+    Check_Fast_Run(ADV_SCHED_FAST_WINDOW_MS);
+
+    Stub_Clock_Advance(ADV_SCHED_FAST_WINDOW_MS * 1000LL); /* The burst runs out */
+    Adv_Complete();
+    CHECK_EQ(Stub_Gap_State.adv_starts, 2);
+    CHECK_EQ(Stub_Gap_State.adv_duration_ms, BLE_HS_FOREVER);
+    CHECK_EQ(Stub_Gap_State.adv_params.itvl_min, BLE_GAP_ADV_ITVL_MS(ADV_SCHED_SLOW_ITVL_MIN_MS));
+
+    Host_App_Connect(1, 0); /* 15 s before the wrap */
+    Host_App_Disconnect(1);
+    Check_Fast_Run(ADV_SCHED_FAST_WINDOW_MS);
+
+    Stub_Clock_Advance(20000 * 1000LL); /* The clock wraps during the burst */
+    CHECK((uint32_t)(esp_timer_get_time() / 1000) < 10000);
+    Adv_Complete(); /* The run was cut short, the rest of the burst is still fast */
+    Check_Fast_Run(ADV_SCHED_FAST_WINDOW_MS - 20000);
+
+    Host_App_Connect(1, 0);
+    CHECK_EQ(Host_App_Read(Diagnostics_Characteristic, 1, NULL, snapshot, &len), 0);
+    CHECK_EQ(Get_U32(&snapshot[reconnect_offset]), 1);
+    uint32_t latency = Get_U32(&snapshot[reconnect_offset + 4]);
+    CHECK(latency >= 20000 && latency < 20020); /* Not a wrapped value near 2^32 */
+}
+
+int main(void)
+{
+    Stub_Log_Output(NULL);
+
+    Test_Burst_Back_Off(0);
+    Test_Burst_Back_Off(123456);
+    Test_Burst_Back_Off(UINT32_MAX - 12345);                      /* The boot burst crosses the wrap */
+    Test_Burst_Back_Off(UINT32_MAX - ADV_SCHED_FAST_WINDOW_MS + 1); /* The boot burst ends just after the wrap */
+    Test_Burst_Back_Off(UINT32_MAX);
+    Test_Wrap_Stepping();
+    Test_App_Across_Wrap();
+
+    printf("test_adv_sched: all checks passed\n");
+    return 0;
+}
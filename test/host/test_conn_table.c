@@ -0,0 +1,198 @@
+/* BLE GATT example - connection table tests
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <freertos/timers.h> /* This is the timer stand-in, for the timer task handle */
+#include "host_test.h"       /* This is the test helpers */
+#include "host_app.h"        /* This is the application bring-up */
+#include "host_stub.h"       /* This is the stand-in control interface */
+#include "conn_table.h"      /* This is the connection table under test */
+#include "gatt_svr.h"        /* This is the GATT services, for the attribute handles */
+
+/**
+ * @brief Handles seen by one walk of the table
+ */
+typedef struct
+{
+    size_t count;                       /* Connections visited */
+    uint16_t handles[CONN_TABLE_SIZE]; /* Their handles, in visiting order */
+} Visit_Log;
+
+static void Record_Visit(Connection_State *conn, void *arg)
+{
+    Visit_Log *log = arg;
+
+    CHECK(log->count < CONN_TABLE_SIZE);
+    log->handles[log->count++] = conn->conn_handle;
+}
+
+/**
+ * @brief Check the subscribed walk visits exactly the expected handles
+ *
+ * @param expected Handles expected, in table order
+ * @param count Number of handles expected
+ */
+static void Check_Subscribed(const uint16_t *expected, size_t count)
+{
+    Visit_Log log = {0};
+
+    CHECK_EQ(Conn_Table_For_Each_Subscribed(Record_Visit, &log), count);
+    CHECK_EQ(log.count, count);
+    CHECK_EQ(Conn_Table_Subscribed_Count(), count);
+    for (size_t i = 0; i < count; i++)
+    {
+        CHECK_EQ(log.handles[i], expected[i]);
+    }
+}
+
+static void Test_Fill_And_Refuse(void)
+{
+    Connection_State *slots[CONN_TABLE_SIZE];
+
+    Conn_Table_Init();
+    for (uint16_t i = 0; i < CONN_TABLE_SIZE; i++) /* Fill every slot */
+    {
+        slots[i] = Conn_Table_Add(10 + i);
+        CHECK(slots[i] != NULL);
+        CHECK_EQ(slots[i]->conn_handle, 10 + i);
+        CHECK_EQ(slots[i]->mtu, CONN_TABLE_DEFAULT_MTU);
+        for (uint16_t j = 0; j < i; j++)
+        {
+            CHECK(slots[i] != slots[j]);
+        }
+    }
+    CHECK_EQ(Conn_Table_Count(), CONN_TABLE_SIZE);
+
+    CHECK(Conn_Table_Add(99) == NULL); /* One more is refused */
+    CHECK(Conn_Table_Find(99) == NULL);
+    CHECK_EQ(Conn_Table_Count(), CONN_TABLE_SIZE);
+    CHECK(!Conn_Table_Set_MTU(99, 247));
+
+    Conn_Table_Remove(10); /* A freed slot is taken by the next connection */
+    CHECK(Conn_Table_Add(99) == slots[0]);
+}
+
+static void Test_Stale_Handle(void)
+{
+    Conn_Table_Init();
+    Connection_State *conn = Conn_Table_Add(5);
+
+    CHECK(Conn_Table_Set_Battery_CCCD(5, CONN_TABLE_CCCD_NOTIFY));
+    CHECK(Conn_Table_Set_MTU(5, 185));
+    conn->bytes_in = 1000;
+
+    CHECK(Conn_Table_Add(5) == conn); /* Disconnect was missed, the slot is reused and cleared */
+    CHECK_EQ(Conn_Table_Count(), 1);
+    CHECK_EQ(conn->battery_cccd, 0);
+    CHECK_EQ(conn->mtu, CONN_TABLE_DEFAULT_MTU);
+    CHECK_EQ(conn->bytes_in, 0);
+    CHECK_EQ(Conn_Table_Subscribed_Count(), 0);
+}
+
+static void Test_Subscribed_Walk(void)
+{
+    Conn_Table_Init();
+    for (uint16_t i = 0; i < CONN_TABLE_SIZE; i++)
+    {
+        Conn_Table_Add(i + 1);
+        CHECK(Conn_Table_Set_Battery_CCCD(i + 1, CONN_TABLE_CCCD_NOTIFY));
+    }
+    CHECK(!Conn_Table_Set_Battery_CCCD(99, CONN_TABLE_CCCD_NOTIFY)); /* Unknown connections are ignored */
+
+    const uint16_t all[] = {1, 2, 3};
+    const uint16_t no_two[] = {1, 3};
+    const uint16_t only_three[] = {3};
+    CHECK_EQ(CONN_TABLE_SIZE, 3);
+    Check_Subscribed(all, 3);
+
+    Conn_Table_Set_Battery_CCCD(2, 0); /* Unsubscribe */
+    Check_Subscribed(no_two, 2);
+    CHECK_EQ(Conn_Table_Count(), 3);
+
+    Conn_Table_Remove(1); /* Disconnect while subscribed */
+    Check_Subscribed(only_three, 1);
+    CHECK_EQ(Conn_Table_Count(), 2);
+
+    Conn_Table_Set_Battery_CCCD(3, 0);
+    Check_Subscribed(NULL, 0);
+
+    Conn_Table_Set_Battery_CCCD(2, CONN_TABLE_CCCD_NOTIFY); /* Subscribe again */
+    const uint16_t only_two[] = {2};
+    Check_Subscribed(only_two, 1);
+
+    Conn_Table_Remove(2);
+    Conn_Table_Remove(3);
+    Check_Subscribed(NULL, 0);
+    CHECK_EQ(Conn_Table_Count(), 0);
+}
+
+/**
+ * @brief Notification hook failing if a notification is sent outside the host task
+ */
+static void Check_Host_Task(uint16_t conn_handle, uint16_t attr_handle, const uint8_t *data, uint16_t len, void *arg)
+{
+    CHECK(xTaskGetCurrentTaskHandle() != xTimerGetTimerDaemonTaskHandle());
+}
+
+static void Test_Timers_Defer_To_Host_Task(void)
+{
+    Host_App_Start(NULL, NULL);
+    for (uint16_t conn = 1; conn <= CONN_TABLE_SIZE; conn++)
+    {
+        Host_App_Connect(conn, 247);
+        Host_App_Subscribe(conn, Battery_level_characteristic_attribute_handler, true);
+        Host_App_Subscribe(conn, Sensor_Stream_characteristic_attribute_handler, true);
+    }
+    Stub_Notify_State.hook = Check_Host_Task;
+
+    Stub_Tick_Advance(pdMS_TO_TICKS(5000)); /* Battery, flush and sensor timers all fire */
+    CHECK(Stub_Notify_State.count > 0);
+
+    Host_App_Disconnect(2); /* Connections come and go between timer ticks */
+    Host_App_Subscribe(3, Battery_level_characteristic_attribute_handler, false);
+    Stub_Tick_Advance(pdMS_TO_TICKS(5000));
+    CHECK_EQ(Conn_Table_Count(), CONN_TABLE_SIZE - 1);
+    CHECK_EQ(Conn_Table_Subscribed_Count(), 1);
+}
+
+static void Test_Connect_Table_Full(void)
+{
+    uint32_t adv_starts;
+
+    Host_App_Connect(4, 0); /* Takes the slot connection 2 left */
+    CHECK_EQ(Conn_Table_Count(), CONN_TABLE_SIZE);
+    CHECK_EQ(Stub_Gap_State.terminate_calls, 0);
+
+    adv_starts = Stub_Gap_State.adv_starts;
+    Host_App_Connect(5, 0); /* One more than the table holds */
+    CHECK(Conn_Table_Find(5) == NULL);
+    CHECK_EQ(Stub_Gap_State.terminate_calls, 1);
+    CHECK_EQ(Stub_Gap_State.terminate_handle, 5);
+    CHECK_EQ(Stub_Gap_State.terminate_reason, BLE_ERR_CONN_LIMIT);
+
+    Host_App_Disconnect(5); /* The refused link goes down without freeing a slot */
+    CHECK_EQ(Conn_Table_Count(), CONN_TABLE_SIZE);
+    CHECK_EQ(Stub_Gap_State.adv_starts, adv_starts);
+    CHECK(!Stub_Gap_State.adv_active);
+
+    Host_App_Disconnect(4);
+    CHECK_EQ(Stub_Gap_State.adv_starts, adv_starts + 1); /* A real slot frees up: advertise again */
+}
+
+int main(void)
+{
+    Stub_Log_Output(NULL);
+
+    Test_Fill_And_Refuse();
+    Test_Stale_Handle();
+    Test_Subscribed_Walk();
+    Test_Timers_Defer_To_Host_Task();
+    Test_Connect_Table_Full();
+
+    printf("test_conn_table: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,161 @@
+/* BLE GATT example - long reads of the diagnostics characteristic
+
+   Reads the diagnostics snapshot in parts, as a client with a small MTU does
+   with Read Blob requests, while the counters keep moving, and checks that
+   the parts come from a single snapshot. Also checks that every connection
+   reads its own snapshot, that a read ending on a part boundary and an
+   abandoned read start over, and that the bytes written are only counted
+   once the ingest pipeline has taken them.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <string.h>     /* This is the standard C lib used for memcmp */
+#include "host_test.h"  /* This is the test helpers */
+#include "host_app.h"   /* This is the application bring-up */
+#include "host_stub.h"  /* This is the stand-in control interface */
+#include "gatt_svr.h"   /* This is the GATT services, for the diagnostics callback */
+#include "conn_table.h" /* This is the per-connection state table */
+#include "ingest.h"     /* This is the write ingest pipeline, for its frame limit */
+#include "diag.h"       /* This is the runtime performance counters */
+
+#define UNTRACKED_HANDLE 9 /* Connection the table does not know, always served a fresh snapshot */
+
+/**
+ * @brief Offset of a counter in the snapshot
+ */
+static size_t Counter_Offset(Diag_Counter counter)
+{
+    return 2 + counter * 4;
+}
+
+/**
+ * @brief Read a little endian 32-bit value
+ */
+static uint32_t Get_U32(const uint8_t *src)
+{
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+/**
+ * @brief Read the diagnostics in parts until a short part ends the read
+ *
+ * @param conn_handle Connection handle
+ * @param mtu ATT MTU of the connection
+ * @param out Filled with the value
+ * @param bump Counter moved between the parts
+ * @return uint16_t Length of the value
+ */
+static uint16_t Long_Read(uint16_t conn_handle, uint16_t mtu, uint8_t *out, Diag_Counter bump)
+{
+    uint16_t offset = 0;
+    uint16_t len;
+
+    do
+    {
+        CHECK_EQ(Host_App_Read_Part(Diagnostics_Characteristic, conn_handle, NULL, offset, mtu, out + offset, &len), 0);
+        offset += len;
+        Diag_Count(bump); /* The counters keep running between requests */
+    } while (len == mtu - 1);
+    return offset;
+}
+
+/**
+ * @brief Take a snapshot outside any connection's long read
+ */
+static uint16_t Fresh_Snapshot(uint8_t *out)
+{
+    uint16_t len = DIAG_SNAPSHOT_MAX_SIZE;
+
+    CHECK_EQ(Host_App_Read(Diagnostics_Characteristic, UNTRACKED_HANDLE, NULL, out, &len), 0);
+    return len;
+}
+
+static void Test_Consistent_Parts(void)
+{
+    uint8_t before[DIAG_SNAPSHOT_MAX_SIZE];
+    uint8_t value[DIAG_SNAPSHOT_MAX_SIZE];
+    uint8_t other[DIAG_SNAPSHOT_MAX_SIZE];
+    uint16_t len;
+
+    uint16_t expected = Fresh_Snapshot(before);
+    CHECK_EQ(expected, 2 + (DIAG_COUNTER_COUNT + 3 + DIAG_HISTOGRAM_BUCKETS + 2) * 4 + 3 * 2 + 2 * 12); /* Two connections */
+
+    CHECK_EQ(Long_Read(1, 23, value, DIAG_WRITE_DROPPED), expected); /* Seven parts, the counter moving after each */
+    CHECK(memcmp(value, before, expected) == 0);                    /* All from the snapshot taken for the first */
+
+    CHECK_EQ(Long_Read(1, 23, value, DIAG_WRITE_DROPPED), expected); /* The next read starts over */
+    CHECK_EQ(Get_U32(&value[Counter_Offset(DIAG_WRITE_DROPPED)]), Get_U32(&before[Counter_Offset(DIAG_WRITE_DROPPED)]) + 7);
+
+    CHECK_EQ(Host_App_Read_Part(Diagnostics_Characteristic, 1, NULL, 0, 23, value, &len), 0); /* Connection 1 reads its first part */
+    Diag_Count(DIAG_WRITE_DROPPED);
+    CHECK_EQ(Long_Read(2, 185, other, DIAG_WRITE_DROPPED), expected); /* Connection 2 reads all of a newer one meanwhile */
+    CHECK_EQ(Get_U32(&other[Counter_Offset(DIAG_WRITE_DROPPED)]), Get_U32(&value[Counter_Offset(DIAG_WRITE_DROPPED)]) + 1);
+    for (uint16_t offset = 22; len == 22; offset += len) /* Connection 1 finishes its own */
+    {
+        CHECK_EQ(Host_App_Read_Part(Diagnostics_Characteristic, 1, NULL, offset, 23, value + offset, &len), 0);
+    }
+    CHECK_EQ(Get_U32(&value[Counter_Offset(DIAG_WRITE_DROPPED)]), Get_U32(&before[Counter_Offset(DIAG_WRITE_DROPPED)]) + 14);
+}
+
+static void Test_Part_Boundary(void)
+{
+    uint8_t value[DIAG_SNAPSHOT_MAX_SIZE];
+    uint16_t len;
+
+    Host_App_Connect(3, 0);
+    Conn_Table_Set_MTU(3, 41); /* 160 bytes with three connections: four parts of 40, then an empty one */
+    uint16_t expected = Fresh_Snapshot(value);
+    CHECK_EQ(expected, 4 * 40);
+
+    CHECK_EQ(Long_Read(3, 41, value, DIAG_WRITE_DROPPED), expected);
+    CHECK_EQ(Host_App_Read_Part(Diagnostics_Characteristic, 3, NULL, 0, 41, value, &len), 0); /* The empty part ended the read */
+    CHECK_EQ(Get_U32(&value[Counter_Offset(DIAG_WRITE_DROPPED)]), atomic_load(&Diag_Counters[DIAG_WRITE_DROPPED]));
+    Host_App_Disconnect(3);
+}
+
+static void Test_Abandoned_Read(void)
+{
+    uint8_t value[DIAG_SNAPSHOT_MAX_SIZE];
+    uint16_t len;
+
+    CHECK_EQ(Host_App_Read_Part(Diagnostics_Characteristic, 1, NULL, 0, 23, value, &len), 0); /* The client gives up after one part */
+    Diag_Count(DIAG_WRITE_DROPPED);
+    Stub_Tick_Advance(pdMS_TO_TICKS(500));
+    CHECK_EQ(Host_App_Read_Part(Diagnostics_Characteristic, 1, NULL, 0, 23, value, &len), 0); /* Too soon: still the old snapshot */
+    CHECK_EQ(Get_U32(&value[Counter_Offset(DIAG_WRITE_DROPPED)]) + 1, atomic_load(&Diag_Counters[DIAG_WRITE_DROPPED]));
+
+    Stub_Tick_Advance(pdMS_TO_TICKS(1000)); /* Idle for a second since the last part */
+    CHECK_EQ(Host_App_Read_Part(Diagnostics_Characteristic, 1, NULL, 0, 23, value, &len), 0);
+    CHECK_EQ(Get_U32(&value[Counter_Offset(DIAG_WRITE_DROPPED)]), atomic_load(&Diag_Counters[DIAG_WRITE_DROPPED]));
+}
+
+static void Test_Bytes_In(void)
+{
+    static uint8_t frame[INGEST_MAX_FRAME + 1];
+    Connection_State *conn = Conn_Table_Find(2);
+
+    CHECK_EQ(Host_App_Write(Custom_Service, 2, NULL, frame, 20, 0), 0);
+    CHECK_EQ(conn->bytes_in, 20);
+    CHECK_EQ(Host_App_Write(Custom_Service, 2, NULL, frame, INGEST_MAX_FRAME + 1, 100), BLE_ATT_ERR_INSUFFICIENT_RES);
+    CHECK_EQ(conn->bytes_in, 20); /* Refused by the ingest pipeline, not counted */
+}
+
+int main(void)
+{
+    Stub_Log_Output(NULL);
+    Host_App_Start(NULL, NULL);
+    Host_App_Connect(1, 23);
+    Host_App_Connect(2, 185);
+
+    Test_Consistent_Parts();
+    Test_Part_Boundary();
+    Test_Abandoned_Read();
+    Test_Bytes_In();
+
+    printf("test_diag_read: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,176 @@
+/* BLE GATT example - link negotiation replayed through the GAP event handler
+
+   Replays connects, MTU exchanges, connection parameter and PHY updates,
+   refused requests and disconnects through BLE_gap_event, and checks the
+   link state and notification budget kept for each connection. The budget
+   is then checked to throttle the sensor stream on a slow link without
+   holding back a fast one.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include "host_test.h"   /* This is the test helpers */
+#include "host_app.h"    /* This is the application bring-up */
+#include "host_stub.h"   /* This is the stand-in control interface */
+#include "gap_svr.h"     /* This is the GAP event handling under test */
+#include "gatt_svr.h"    /* This is the GATT services, for the attribute handles */
+#include "conn_table.h"  /* This is the per-connection state table */
+#include "conn_params.h" /* This is the connection parameter negotiation */
+#include "diag.h"        /* This is the runtime performance counters */
+
+#define PENDING_AFTER_CONNECT (CONN_PARAMS_PENDING_UPDATE | CONN_PARAMS_PENDING_PHY) /* MTU answered by Host_App_Connect */
+
+static uint32_t Stream_Frames[4]; /* Sensor stream notifications per connection handle */
+
+static void Count_Stream_Frame(uint16_t conn_handle, uint16_t attr_handle, const uint8_t *data, uint16_t len, void *arg)
+{
+    if (attr_handle == Sensor_Stream_characteristic_attribute_handler && conn_handle < 4)
+    {
+        Stream_Frames[conn_handle]++;
+    }
+}
+
+/**
+ * @brief Replay a connection parameter update, after the controller switched to the given interval
+ */
+static void Conn_Update(uint16_t conn_handle, int status, uint16_t itvl)
+{
+    struct ble_gap_event event = {.type = BLE_GAP_EVENT_CONN_UPDATE};
+
+    Stub_Gap_Set_Conn(conn_handle, itvl, 0, 400);
+    event.conn_update.status = status;
+    event.conn_update.conn_handle = conn_handle;
+    BLE_gap_event(&event, NULL);
+}
+
+/**
+ * @brief Replay a PHY update
+ */
+static void Phy_Update(uint16_t conn_handle, int status, uint8_t phy)
+{
+    struct ble_gap_event event = {.type = BLE_GAP_EVENT_PHY_UPDATE_COMPLETE};
+
+    event.phy_updated.status = status;
+    event.phy_updated.conn_handle = conn_handle;
+    event.phy_updated.tx_phy = phy;
+    event.phy_updated.rx_phy = phy;
+    BLE_gap_event(&event, NULL);
+}
+
+static void Test_Budget_Take(void)
+{
+    Conn_Link link;
+
+    Conn_Params_Init_Link(&link);
+    CHECK(Conn_Params_Budget_Take(&link, 0, 500)); /* Budget unknown, not limited */
+
+    link.throughput_bps = 1000; /* 100 bytes may be saved up */
+    CHECK(Conn_Params_Budget_Take(&link, 1000, 60));
+    CHECK(!Conn_Params_Budget_Take(&link, 1000, 60)); /* 40 left */
+    CHECK(Conn_Params_Budget_Take(&link, 1010, 50));  /* 10 earned in 10 ms */
+    CHECK(!Conn_Params_Budget_Take(&link, 1010, 1));
+    CHECK(Conn_Params_Budget_Take(&link, 5000, 100)); /* Seconds later the bucket is only full */
+    CHECK(!Conn_Params_Budget_Take(&link, 5000, 1));
+
+    CHECK(!Conn_Params_Budget_Take(&link, 5100, 300)); /* Larger than the bucket: waits for a whole one */
+    CHECK(Conn_Params_Budget_Take(&link, 5300, 300));
+
+    link.budget_ms = UINT32_MAX - 4; /* Earned across the wrap of the clock */
+    link.budget_bytes = 0;
+    CHECK(!Conn_Params_Budget_Take(&link, 14, 21));
+    CHECK(Conn_Params_Budget_Take(&link, 14, 19));
+}
+
+static void Test_Replay(void)
+{
+    Host_App_Start(NULL, NULL);
+
+    Host_App_Connect(1, 247); /* Central picks a 30 ms interval on 1M */
+    Connection_State *conn = Conn_Table_Find(1);
+    CHECK(conn != NULL);
+    CHECK_EQ(conn->link.itvl, 24);
+    CHECK_EQ(conn->link.pending, PENDING_AFTER_CONNECT);
+    CHECK_EQ(conn->link.rejected, 0);
+    CHECK_EQ(Stub_Gap_State.data_len_tx_octets, 251);
+    CHECK_EQ(conn->link.tx_octets_requested, 251);
+    CHECK_EQ(conn->link.tx_octets, CONN_PARAMS_DEFAULT_TX_OCTETS); /* No event reports what the peer accepted */
+    CHECK_EQ(conn->link.throughput_bps, 5249);                     /* 6 PDUs of 27 octets per 30 ms, minus headers */
+    CHECK_EQ(conn->link.throughput_bps, Conn_Params_Budget(&conn->link, 247));
+
+    Conn_Update(1, 0, 12); /* The profile's 15 ms interval is accepted */
+    CHECK_EQ(conn->link.itvl, 12);
+    CHECK_EQ(conn->link.pending, CONN_PARAMS_PENDING_PHY);
+    CHECK_EQ(conn->link.throughput_bps, 10498);
+
+    Phy_Update(1, 0, CONN_PARAMS_PHY_2M);
+    CHECK_EQ(conn->link.tx_phy, CONN_PARAMS_PHY_2M);
+    CHECK_EQ(conn->link.pending, 0); /* The data length request was never left pending */
+
+    Conn_Update(1, BLE_HS_EBUSY, 80); /* A failed update keeps the parameters in use */
+    CHECK_EQ(conn->link.itvl, 12);
+    CHECK_EQ(conn->link.rejected, 0); /* Nothing of ours was pending */
+
+    Phy_Update(1, BLE_HS_ENOTSUP, CONN_PARAMS_PHY_1M);
+    CHECK_EQ(conn->link.tx_phy, CONN_PARAMS_PHY_2M);
+    CHECK_EQ(conn->link.rejected, CONN_PARAMS_PENDING_PHY);
+
+    Conn_Update(77, 0, 12); /* Unknown connections are ignored */
+    Phy_Update(77, 0, CONN_PARAMS_PHY_2M);
+
+    Stub_Gap_State.data_len_rc = BLE_HS_ENOTSUP; /* A 4.2 controller refuses both */
+    Stub_Gap_State.phy_rc = BLE_HS_ENOTSUP;
+    Host_App_Connect(2, 0);
+    Connection_State *old = Conn_Table_Find(2);
+    CHECK_EQ(old->link.rejected, CONN_PARAMS_PENDING_DATA_LEN | CONN_PARAMS_PENDING_PHY);
+    CHECK_EQ(old->link.pending, CONN_PARAMS_PENDING_UPDATE | CONN_PARAMS_PENDING_MTU);
+    CHECK_EQ(old->link.tx_octets_requested, 0);
+    CHECK_EQ(old->link.throughput_bps, 4000); /* Default MTU until the exchange completes */
+    Stub_Gap_State.data_len_rc = 0;
+    Stub_Gap_State.phy_rc = 0;
+
+    Host_App_Disconnect(1); /* A reconnect starts from a fresh link */
+    Host_App_Connect(1, 185);
+    CHECK_EQ(conn->link.itvl, 24);
+    CHECK_EQ(conn->link.tx_phy, CONN_PARAMS_PHY_1M);
+    CHECK_EQ(conn->link.rejected, 0);
+    CHECK_EQ(conn->link.pending, PENDING_AFTER_CONNECT);
+    Host_App_Disconnect(1);
+    Host_App_Disconnect(2);
+}
+
+static void Test_Stream_Budget(void)
+{
+    unsigned over = atomic_load(&Diag_Counters[DIAG_STREAM_OVER_BUDGET]);
+
+    Host_App_Connect(1, 247);
+    Host_App_Connect(2, 247);
+    Conn_Update(1, 0, 3200); /* The central slows connection 1 to 4 s */
+    Connection_State *slow = Conn_Table_Find(1);
+    CHECK_EQ(slow->link.throughput_bps, 38); /* 6 PDUs of 27 octets every 4 s */
+    CHECK_EQ(Conn_Table_Find(2)->link.throughput_bps, 5249);
+
+    Host_App_Subscribe(1, Sensor_Stream_characteristic_attribute_handler, true);
+    Host_App_Subscribe(2, Sensor_Stream_characteristic_attribute_handler, true);
+    Stub_Notify_State.hook = Count_Stream_Frame;
+    Stub_Tick_Advance(pdMS_TO_TICKS(10000)); /* 1000 samples, a 24-byte frame every 110 ms */
+
+    CHECK(Stream_Frames[2] >= 1000 / 11);                                  /* The fast link gets every frame, 11 samples each */
+    CHECK(Stream_Frames[1] >= 10 && Stream_Frames[1] <= 10 * 38 / 24 + 2); /* The slow one only what it can carry */
+    CHECK_EQ(atomic_load(&Diag_Counters[DIAG_STREAM_OVER_BUDGET]) - over, Stream_Frames[2] - Stream_Frames[1]);
+    CHECK(slow->bytes_out <= 10 * 38 + 24);
+}
+
+int main(void)
+{
+    Stub_Log_Output(NULL);
+
+    Test_Budget_Take();
+    Test_Replay();
+    Test_Stream_Budget();
+
+    printf("test_gap_replay: all checks passed\n");
+    return 0;
+}
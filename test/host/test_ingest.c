@@ -0,0 +1,212 @@
+/* BLE GATT example - write ingest pipeline tests
+
+   Submits chained buffers of various segment sizes and checks that the
+   worker sees every byte in order, fills the ring behind a stalled worker,
+   then measures the ingest throughput for short and long writes.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <sched.h>       /* This is the POSIX lib used to let the worker run */
+#include <stdatomic.h>   /* This is the standard C lib used for the state shared with the worker */
+#include "host_test.h"   /* This is the test helpers */
+#include "host_stub.h"   /* This is the stand-in control interface */
+#include "ingest.h"      /* This is the write ingest pipeline under test */
+#include "gatt_svr.h"    /* This is the GATT services, for the write callback */
+#include "conn_table.h"  /* This is the per-connection state table */
+#include "diag.h"        /* This is the runtime performance counters */
+
+#define TEST_RECORD_MAX 32       /* Frames whose checksum is kept */
+#define THROUGHPUT_FRAMES 200000 /* Frames submitted per throughput run */
+
+/**
+ * @brief What the worker has seen, written by the worker and read by the test
+ */
+typedef struct
+{
+    atomic_uint handled;                 /* Frames handled, released after the fields below */
+    atomic_bool gate_open;               /* Cleared to stall the worker inside the handler */
+    uint16_t lens[TEST_RECORD_MAX];      /* Length of each recorded frame */
+    uint32_t checksums[TEST_RECORD_MAX]; /* Checksum of each recorded frame */
+    uint64_t bytes;                      /* Bytes handled */
+} Test_Ingest_State;
+
+static Test_Ingest_State State;
+static uint8_t Payload[INGEST_MAX_FRAME + 1];
+
+/**
+ * @brief Order sensitive checksum, so swapped or repeated segments are caught
+ */
+static uint32_t Checksum(const uint8_t *data, size_t len)
+{
+    uint32_t a = 1;
+    uint32_t b = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+static void Test_Handler(const uint8_t *data, size_t len, void *arg)
+{
+    Test_Ingest_State *state = arg;
+    unsigned index = atomic_load_explicit(&state->handled, memory_order_relaxed);
+
+    while (!atomic_load_explicit(&state->gate_open, memory_order_acquire)) /* Stalled by the test */
+    {
+        sched_yield();
+    }
+    if (index < TEST_RECORD_MAX)
+    {
+        state->lens[index] = len;
+        state->checksums[index] = Checksum(data, len);
+    }
+    state->bytes += len;
+    atomic_store_explicit(&state->handled, index + 1, memory_order_release);
+}
+
+/**
+ * @brief Wait for the worker to handle a number of frames in total
+ */
+static void Wait_Handled(unsigned count)
+{
+    while (atomic_load_explicit(&State.handled, memory_order_acquire) < count)
+    {
+        sched_yield();
+    }
+}
+
+/**
+ * @brief Submit a frame, waiting for room in the ring
+ */
+static void Submit_Retry(const struct os_mbuf *om)
+{
+    while (Ingest_Submit(om) != 0)
+    {
+        sched_yield();
+    }
+}
+
+static void Test_Chained_Segments(void)
+{
+    static const uint16_t lengths[] = {1, 20, 244, INGEST_MAX_FRAME};
+    static const uint16_t segments[] = {0, 13, 27, 100}; /* 0 puts the frame in a single buffer */
+    uint16_t lens[TEST_RECORD_MAX];
+    uint32_t checksums[TEST_RECORD_MAX];
+    unsigned count = 0;
+
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+    {
+        for (size_t s = 0; s < sizeof(segments) / sizeof(segments[0]); s++)
+        {
+            const uint8_t *data = &Payload[count]; /* A different window of the payload each time */
+            struct os_mbuf *om = Stub_Mbuf_Chain(data, lengths[l], segments[s]);
+
+            CHECK(om != NULL);
+            CHECK_EQ(OS_MBUF_PKTLEN(om), lengths[l]);
+            CHECK_EQ(Ingest_Submit(om), 0);
+            os_mbuf_free_chain(om); /* The ring holds a copy */
+
+            lens[count] = lengths[l];
+            checksums[count] = Checksum(data, lengths[l]);
+            count++;
+            Wait_Handled(count);
+        }
+    }
+
+    for (unsigned i = 0; i < count; i++) /* Every byte arrived, in order */
+    {
+        CHECK_EQ(State.lens[i], lens[i]);
+        CHECK_EQ(State.checksums[i], checksums[i]);
+    }
+
+    struct os_mbuf *om = Stub_Mbuf_Chain(Payload, INGEST_MAX_FRAME + 1, 100); /* Longer than any attribute value */
+    CHECK_EQ(Ingest_Submit(om), BLE_HS_ENOMEM);
+    os_mbuf_free_chain(om);
+    CHECK_EQ(atomic_load(&State.handled), count);
+}
+
+static void Test_Ring_Full(void)
+{
+    struct ble_gatt_access_ctxt ctxt = {.op = BLE_GATT_ACCESS_OP_WRITE_CHR, .om = Stub_Mbuf_Chain(Payload, 20, 0)};
+    unsigned handled = atomic_load(&State.handled);
+    unsigned received = atomic_load(&Diag_Counters[DIAG_WRITE_RECEIVED]);
+    unsigned dropped = atomic_load(&Diag_Counters[DIAG_WRITE_DROPPED]);
+    unsigned accepted = 0;
+    int rc;
+
+    Conn_Table_Init();
+    Conn_Table_Add(1);
+    atomic_store(&State.gate_open, false); /* The worker stops inside the handler, holding its slots */
+
+    while ((rc = Custom_Service(1, 0, &ctxt, NULL)) == 0)
+    {
+        accepted++;
+        CHECK(accepted <= INGEST_RING_SLOTS);
+        sched_yield(); /* Give the worker a chance to take frames */
+    }
+    CHECK_EQ(rc, BLE_ATT_ERR_INSUFFICIENT_RES);
+    CHECK_EQ(accepted, INGEST_RING_SLOTS); /* Slots are only given back once the worker is done with them */
+    CHECK_EQ(atomic_load(&Diag_Counters[DIAG_WRITE_RECEIVED]) - received, accepted + 1);
+    CHECK_EQ(atomic_load(&Diag_Counters[DIAG_WRITE_DROPPED]) - dropped, 1);
+    CHECK_EQ(Conn_Table_Find(1)->bytes_in, accepted * 20); /* The refused write is not counted */
+
+    atomic_store(&State.gate_open, true); /* The worker catches up */
+    Wait_Handled(handled + accepted);
+    CHECK_EQ(Custom_Service(1, 0, &ctxt, NULL), 0);
+    Wait_Handled(handled + accepted + 1);
+    os_mbuf_free_chain(ctxt.om);
+}
+
+/**
+ * @brief Measure the ingest throughput for one frame shape
+ *
+ * @param name Name printed with the result
+ * @param len Length of each frame
+ * @param segment Length of each buffer of the chain, 0 for a single buffer
+ */
+static void Test_Throughput(const char *name, uint16_t len, uint16_t segment)
+{
+    struct os_mbuf *om = Stub_Mbuf_Chain(Payload, len, segment);
+    unsigned handled = atomic_load(&State.handled);
+    uint64_t bytes = State.bytes;
+
+    uint64_t start = Host_Test_Now_Ns();
+    for (uint32_t i = 0; i < THROUGHPUT_FRAMES; i++)
+    {
+        Submit_Retry(om);
+    }
+    Wait_Handled(handled + THROUGHPUT_FRAMES);
+    uint64_t elapsed = Host_Test_Now_Ns() - start;
+
+    CHECK_EQ(State.bytes - bytes, (uint64_t)len * THROUGHPUT_FRAMES);
+    Host_Test_Report(name, elapsed, THROUGHPUT_FRAMES);
+    printf("%-40s %10.1f MB/s\n", "", (double)len * THROUGHPUT_FRAMES * 1000.0 / (double)elapsed);
+    os_mbuf_free_chain(om);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(Payload); i++)
+    {
+        Payload[i] = (uint8_t)(i * 7 + 3);
+    }
+    Stub_Log_Output(NULL);
+    atomic_store(&State.gate_open, true);
+    Ingest_Init(Test_Handler, &State);
+
+    Test_Chained_Segments();
+    Test_Ring_Full();
+    Test_Throughput("ingest 20 bytes, one buffer", 20, 0);
+    Test_Throughput("ingest 244 bytes, 100 byte segments", 244, 100);
+    Test_Throughput("ingest 512 bytes, 27 byte segments", INGEST_MAX_FRAME, 27);
+
+    printf("test_ingest: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,165 @@
+/* BLE GATT example - notification buffer pool tests
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <string.h>      /* This is the standard C lib used for memcmp */
+#include "host_test.h"   /* This is the test helpers */
+#include "host_app.h"    /* This is the application bring-up */
+#include "host_stub.h"   /* This is the stand-in control interface */
+#include "notify_pool.h" /* This is the notification buffer pool under test */
+#include "gatt_svr.h"    /* This is the GATT services, for the attribute handles */
+#include "diag.h"        /* This is the runtime performance counters */
+
+#define SMALL_PAYLOAD 20  /* Fits the first block */
+#define LARGE_PAYLOAD 244 /* Needs three chained blocks */
+
+static uint8_t Payload[LARGE_PAYLOAD];
+
+/**
+ * @brief Read a little endian 16-bit value
+ */
+static uint16_t Get_U16(const uint8_t *src)
+{
+    return src[0] | (src[1] << 8);
+}
+
+/**
+ * @brief Read a little endian 32-bit value
+ */
+static uint32_t Get_U32(const uint8_t *src)
+{
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+static void Test_Exhaust_And_Recover(void)
+{
+    struct os_mbuf *held[NOTIFY_POOL_BLOCK_COUNT];
+    Notify_Pool_Stats stats;
+
+    Notify_Pool_Init();
+    Notify_Pool_Get_Stats(&stats);
+    CHECK_EQ(stats.block_count, NOTIFY_POOL_BLOCK_COUNT);
+    CHECK_EQ(stats.in_use, 0);
+
+    for (size_t i = 0; i < NOTIFY_POOL_BLOCK_COUNT; i++) /* Storm: nothing is given back */
+    {
+        held[i] = Notify_Pool_Get(Payload, SMALL_PAYLOAD);
+        CHECK(held[i] != NULL);
+        CHECK_EQ(OS_MBUF_PKTLEN(held[i]), SMALL_PAYLOAD);
+    }
+    CHECK(Notify_Pool_Get(Payload, SMALL_PAYLOAD) == NULL); /* Exhausted, the caller backs off */
+
+    Notify_Pool_Get_Stats(&stats);
+    CHECK_EQ(stats.allocations, NOTIFY_POOL_BLOCK_COUNT);
+    CHECK_EQ(stats.failures, 1);
+    CHECK_EQ(stats.in_use, NOTIFY_POOL_BLOCK_COUNT);
+    CHECK_EQ(stats.peak_in_use, NOTIFY_POOL_BLOCK_COUNT);
+
+    for (size_t i = 0; i < NOTIFY_POOL_BLOCK_COUNT; i++) /* The controller sends them */
+    {
+        os_mbuf_free_chain(held[i]);
+    }
+    Notify_Pool_Get_Stats(&stats);
+    CHECK_EQ(stats.in_use, 0);
+    CHECK_EQ(stats.peak_in_use, NOTIFY_POOL_BLOCK_COUNT); /* The peak is kept */
+
+    struct os_mbuf *om = Notify_Pool_Get(Payload, SMALL_PAYLOAD); /* Usable again */
+    CHECK(om != NULL);
+    os_mbuf_free_chain(om);
+}
+
+static void Test_Chained_Payload(void)
+{
+    uint8_t copy[LARGE_PAYLOAD];
+    struct os_mbuf *filler[NOTIFY_POOL_BLOCK_COUNT];
+    Notify_Pool_Stats stats;
+    size_t count = 0;
+
+    Notify_Pool_Init();
+    struct os_mbuf *om = Notify_Pool_Get(Payload, LARGE_PAYLOAD);
+    CHECK(om != NULL);
+    CHECK(SLIST_NEXT(om, om_next) != NULL); /* Longer than one block */
+    CHECK_EQ(OS_MBUF_PKTLEN(om), LARGE_PAYLOAD);
+    CHECK_EQ(os_mbuf_copydata(om, 0, LARGE_PAYLOAD, copy), 0);
+    CHECK(memcmp(copy, Payload, LARGE_PAYLOAD) == 0);
+
+    Notify_Pool_Get_Stats(&stats);
+    CHECK_EQ(stats.in_use, 3);
+    os_mbuf_free_chain(om);
+
+    while (count < NOTIFY_POOL_BLOCK_COUNT - 2) /* Leave two blocks, one short of a large payload */
+    {
+        filler[count++] = Notify_Pool_Get(Payload, SMALL_PAYLOAD);
+    }
+    CHECK(Notify_Pool_Get(Payload, LARGE_PAYLOAD) == NULL);
+    Notify_Pool_Get_Stats(&stats);
+    CHECK_EQ(stats.in_use, NOTIFY_POOL_BLOCK_COUNT - 2); /* The partial chain was given back */
+    CHECK_EQ(stats.failures, 1);
+
+    while (count > 0)
+    {
+        os_mbuf_free_chain(filler[--count]);
+    }
+}
+
+static void Test_Notification_Storm(void)
+{
+    uint8_t snapshot[DIAG_SNAPSHOT_MAX_SIZE];
+    uint16_t len = sizeof(snapshot);
+    const size_t pool_offset = 2 + (DIAG_COUNTER_COUNT + 3 + DIAG_HISTOGRAM_BUCKETS) * 4; /* Pool part of the snapshot */
+    Notify_Pool_Stats stats;
+
+    Host_App_Start(NULL, NULL);
+    for (uint16_t conn = 1; conn <= 3; conn++)
+    {
+        Host_App_Connect(conn, 247);
+        Host_App_Subscribe(conn, Sensor_Stream_characteristic_attribute_handler, true);
+    }
+
+    Stub_Notify_State.hold = true; /* The controller never gets to send */
+    Stub_Tick_Advance(pdMS_TO_TICKS(10000));
+    uint32_t held = Stub_Notify_State.count;
+    CHECK(held > 0);
+    CHECK(atomic_load(&Diag_Counters[DIAG_MBUF_ALLOC_FAILED]) > 0); /* The pool ran out and the sender backed off */
+
+    Notify_Pool_Get_Stats(&stats);
+    CHECK_EQ(stats.in_use, stats.block_count);
+    CHECK(stats.failures > 0);
+
+    CHECK_EQ(Host_App_Read(Diagnostics_Characteristic, 1, NULL, snapshot, &len), 0); /* Exposed in the diagnostics */
+    CHECK_EQ(snapshot[0], DIAG_SNAPSHOT_VERSION);
+    CHECK_EQ(snapshot[1], 3);
+    CHECK_EQ(Get_U32(&snapshot[pool_offset]), stats.allocations);
+    CHECK_EQ(Get_U32(&snapshot[pool_offset + 4]), stats.failures);
+    CHECK_EQ(Get_U16(&snapshot[pool_offset + 8]), stats.in_use);
+    CHECK_EQ(Get_U16(&snapshot[pool_offset + 10]), stats.peak_in_use);
+    CHECK_EQ(Get_U16(&snapshot[pool_offset + 12]), NOTIFY_POOL_BLOCK_COUNT);
+    CHECK_EQ(len, pool_offset + 14 + 3 * 12);
+
+    Stub_Notify_State.hold = false;
+    Stub_Notify_Release_Held(); /* The controller catches up */
+    Stub_Tick_Advance(pdMS_TO_TICKS(1000));
+    CHECK(Stub_Notify_State.count > held); /* Notifications resume */
+    Notify_Pool_Get_Stats(&stats);
+    CHECK_EQ(stats.in_use, 0);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(Payload); i++)
+    {
+        Payload[i] = (uint8_t)(i * 7);
+    }
+    Stub_Log_Output(NULL);
+
+    Test_Exhaust_And_Recover();
+    Test_Chained_Payload();
+    Test_Notification_Storm();
+
+    printf("test_notify_pool: all checks passed\n");
+    return 0;
+}
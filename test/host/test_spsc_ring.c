@@ -0,0 +1,244 @@
+/* BLE GATT example - lock-free SPSC ring tests
+
+   Checks the wrap and full/empty edges on one thread, then streams about two
+   million sequence numbers from a producer thread to a consumer thread with
+   every pairing of the copying and in-place interfaces, and checks that each
+   arrives once and in order. Build with HOST_TSAN to check the memory
+   ordering under ThreadSanitizer.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include <pthread.h>   /* This is the POSIX lib used for the producer and consumer threads */
+#include <sched.h>     /* This is the POSIX lib used to yield when the ring is full or empty */
+#include <string.h>    /* This is the standard C lib used for memcpy */
+#include "host_test.h" /* This is the test helpers */
+#include "spsc_ring.h" /* This is the ring under test */
+
+#define STRESS_ELEMENTS 2000000 /* Elements streamed per run */
+#define STRESS_CAPACITY 64      /* Small, so the ring wraps and fills often */
+#define STRESS_BATCH_MAX 24     /* Largest batch moved at once */
+
+/**
+ * @brief Interfaces used by one side of a stress run
+ */
+typedef enum
+{
+    STRESS_COPY,     /* Spsc_Ring_Push or Spsc_Ring_Pop */
+    STRESS_IN_PLACE, /* Spsc_Ring_Reserve and Commit, or Peek and Release */
+    STRESS_MIXED,    /* Either, chosen at random for each batch */
+} Stress_Mode;
+
+/**
+ * @brief One stress run shared by its two threads
+ */
+typedef struct
+{
+    Spsc_Ring ring;                    /* Ring under test */
+    uint32_t storage[STRESS_CAPACITY]; /* Storage of the ring */
+    Stress_Mode producer;              /* Interfaces used by the producer */
+    Stress_Mode consumer;              /* Interfaces used by the consumer */
+    uint32_t errors;                   /* Elements out of sequence, written by the consumer */
+} Stress_Run;
+
+/**
+ * @brief Small pseudo random generator, one per thread
+ */
+static uint32_t Next_Random(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+/**
+ * @brief Whether the next batch uses the in-place interface
+ */
+static bool Use_In_Place(Stress_Mode mode, uint32_t *random)
+{
+    return mode == STRESS_IN_PLACE || (mode == STRESS_MIXED && (Next_Random(random) & 1));
+}
+
+static void *Stress_Producer(void *arg)
+{
+    Stress_Run *run = arg;
+    uint32_t random = 1;
+    uint32_t next = 0;
+
+    while (next < STRESS_ELEMENTS)
+    {
+        size_t want = 1 + Next_Random(&random) % STRESS_BATCH_MAX;
+        size_t done;
+
+        if (want > STRESS_ELEMENTS - next)
+        {
+            want = STRESS_ELEMENTS - next;
+        }
+
+        if (Use_In_Place(run->producer, &random))
+        {
+            done = want;
+            uint32_t *slots = Spsc_Ring_Reserve(&run->ring, &done);
+            for (size_t i = 0; i < done; i++)
+            {
+                slots[i] = next + i;
+            }
+            if (done != 0)
+            {
+                Spsc_Ring_Commit(&run->ring, done);
+            }
+        }
+        else
+        {
+            uint32_t batch[STRESS_BATCH_MAX];
+            for (size_t i = 0; i < want; i++)
+            {
+                batch[i] = next + i;
+            }
+            done = Spsc_Ring_Push(&run->ring, batch, want);
+        }
+
+        next += done;
+        if (done == 0) /* Full, let the consumer run */
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *Stress_Consumer(void *arg)
+{
+    Stress_Run *run = arg;
+    uint32_t random = 2;
+    uint32_t expected = 0;
+
+    while (expected < STRESS_ELEMENTS)
+    {
+        size_t want = 1 + Next_Random(&random) % STRESS_BATCH_MAX;
+        size_t done;
+
+        if (Use_In_Place(run->consumer, &random))
+        {
+            const uint32_t *elems = Spsc_Ring_Peek(&run->ring, &done);
+            if (done > want) /* Release only part of what is there */
+            {
+                done = want;
+            }
+            for (size_t i = 0; i < done; i++)
+            {
+                run->errors += elems[i] != expected + i;
+            }
+            if (done != 0)
+            {
+                Spsc_Ring_Release(&run->ring, done);
+            }
+        }
+        else
+        {
+            uint32_t batch[STRESS_BATCH_MAX];
+            done = Spsc_Ring_Pop(&run->ring, batch, want);
+            for (size_t i = 0; i < done; i++)
+            {
+                run->errors += batch[i] != expected + i;
+            }
+        }
+
+        expected += done;
+        if (done == 0) /* Empty, let the producer run */
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Stream STRESS_ELEMENTS through a ring between two threads
+ */
+static void Stress(Stress_Mode producer, Stress_Mode consumer)
+{
+    static Stress_Run run;
+    pthread_t threads[2];
+
+    run = (Stress_Run){.producer = producer, .consumer = consumer};
+    CHECK(Spsc_Ring_Init(&run.ring, run.storage, sizeof(run.storage[0]), STRESS_CAPACITY));
+
+    CHECK_EQ(pthread_create(&threads[0], NULL, Stress_Consumer, &run), 0);
+    CHECK_EQ(pthread_create(&threads[1], NULL, Stress_Producer, &run), 0);
+    pthread_join(threads[1], NULL);
+    pthread_join(threads[0], NULL);
+
+    CHECK_EQ(run.errors, 0);
+    CHECK_EQ(Spsc_Ring_Count(&run.ring), 0);
+}
+
+static void Test_Init(void)
+{
+    Spsc_Ring ring;
+    uint32_t storage[8];
+
+    CHECK(!Spsc_Ring_Init(&ring, storage, sizeof(storage[0]), 0));
+    CHECK(!Spsc_Ring_Init(&ring, storage, sizeof(storage[0]), 6)); /* Not a power of two */
+    CHECK(!Spsc_Ring_Init(&ring, storage, 0, 8));
+    CHECK(Spsc_Ring_Init(&ring, storage, sizeof(storage[0]), 8));
+    CHECK_EQ(Spsc_Ring_Count(&ring), 0);
+}
+
+static void Test_Edges(void)
+{
+    Spsc_Ring ring;
+    uint32_t storage[8];
+    uint32_t in[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    uint32_t out[8];
+    size_t count;
+
+    Spsc_Ring_Init(&ring, storage, sizeof(storage[0]), 8);
+    CHECK(Spsc_Ring_Peek(&ring, &count) == NULL); /* Empty */
+    CHECK_EQ(count, 0);
+    CHECK_EQ(Spsc_Ring_Pop(&ring, out, 8), 0);
+
+    CHECK_EQ(Spsc_Ring_Push(&ring, in, 6), 6);
+    CHECK_EQ(Spsc_Ring_Pop(&ring, out, 4), 4); /* Indices now at 6 and 4 */
+    CHECK(memcmp(out, in, 4 * sizeof(in[0])) == 0);
+
+    CHECK_EQ(Spsc_Ring_Push(&ring, in, 8), 6); /* Wraps, and only six fit */
+    CHECK_EQ(Spsc_Ring_Count(&ring), 8);
+    CHECK_EQ(Spsc_Ring_Push(&ring, in, 1), 0); /* Full */
+    count = 1;
+    CHECK(Spsc_Ring_Reserve(&ring, &count) == NULL);
+    CHECK_EQ(count, 0);
+
+    uint32_t *peeked = Spsc_Ring_Peek(&ring, &count); /* Only what the consumer's copy of the head shows */
+    CHECK_EQ(count, 2);
+    CHECK_EQ(peeked[0], 4);
+    CHECK_EQ(peeked[1], 5);
+    Spsc_Ring_Release(&ring, count);
+    CHECK_EQ(Spsc_Ring_Pop(&ring, out, 8), 6); /* Refreshed, and across the end of the storage */
+    CHECK(memcmp(out, in, 6 * sizeof(in[0])) == 0);
+    CHECK_EQ(Spsc_Ring_Count(&ring), 0);
+
+    count = 8; /* Head at 12: four slots before the end of the storage */
+    uint32_t *slots = Spsc_Ring_Reserve(&ring, &count);
+    CHECK_EQ(count, 4);
+    CHECK(slots == &storage[4]);
+    Spsc_Ring_Commit(&ring, 2); /* Commit fewer than granted */
+    CHECK_EQ(Spsc_Ring_Count(&ring), 2);
+}
+
+int main(void)
+{
+    Test_Init();
+    Test_Edges();
+
+    Stress(STRESS_COPY, STRESS_COPY);
+    Stress(STRESS_IN_PLACE, STRESS_IN_PLACE);
+    Stress(STRESS_COPY, STRESS_IN_PLACE);
+    Stress(STRESS_IN_PLACE, STRESS_COPY);
+    Stress(STRESS_MIXED, STRESS_MIXED);
+
+    printf("test_spsc_ring: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,188 @@
+/* BLE GATT example - change driven value publishing tests
+
+   Checks the hysteresis, the per-connection gap and a resubscribe on the
+   publisher itself, then pushes a fast, noisy producer through it and
+   counts the notifications emitted against the values produced. The
+   battery service is then run for a while with two subscribers, and its
+   notifications are counted the same way.
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+#include "host_test.h" /* This is the test helpers */
+#include "host_app.h"  /* This is the application bring-up */
+#include "host_stub.h" /* This is the stand-in control interface */
+#include "gatt_svr.h"  /* This is the GATT services, for the battery characteristic */
+#include "value_pub.h" /* This is the value publishing under test */
+
+#define BURST_TICKS 10000 /* Ticks the noisy producer runs for, one value per tick */
+#define BURST_GAP 3       /* Ticks between notifications, a 30 ms connection interval */
+
+/**
+ * @brief Battery notifications seen by each connection
+ */
+typedef struct
+{
+    uint32_t count[4]; /* Notifications per connection handle */
+    uint8_t last[4];   /* Last level sent to each connection */
+} Battery_Seen;
+
+static Battery_Seen Seen;
+
+static void Count_Battery(uint16_t conn_handle, uint16_t attr_handle, const uint8_t *data, uint16_t len, void *arg)
+{
+    if (attr_handle == Battery_level_characteristic_attribute_handler && conn_handle < 4)
+    {
+        Seen.count[conn_handle]++;
+        Seen.last[conn_handle] = data[0];
+    }
+}
+
+/**
+ * @brief Small pseudo random generator
+ */
+static uint32_t Next_Random(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+static void Test_Policy(void)
+{
+    Value_Pub pub;
+    Value_Pub_Conn conn;
+
+    Value_Pub_Init(&pub, 50, 0); /* Hysteresis 0 behaves as 1 */
+    CHECK_EQ(pub.hysteresis, 1);
+    Value_Pub_Init(&pub, 50, 5);
+    Value_Pub_Reset_Conn(&conn);
+    CHECK_EQ(Value_Pub_Due(&pub, &conn, 0, 10), 0); /* The first value always goes out */
+    Value_Pub_Sent(&pub, &conn, 0);
+
+    Value_Pub_Set(&pub, 54);
+    CHECK_EQ(Value_Pub_Due(&pub, &conn, 100, 10), VALUE_PUB_IDLE); /* Within the hysteresis */
+    Value_Pub_Set(&pub, 45);
+    CHECK_EQ(Value_Pub_Due(&pub, &conn, 4, 10), 6); /* Far enough, but the last one is only 4 ticks old */
+    CHECK_EQ(Value_Pub_Due(&pub, &conn, 10, 10), 0);
+    CHECK_EQ(Value_Pub_Get(&pub), 45);
+
+    Value_Pub_Sent(&pub, &conn, UINT32_MAX - 1); /* Gap measured across the tick wrap */
+    Value_Pub_Set(&pub, 60);
+    CHECK_EQ(Value_Pub_Due(&pub, &conn, 2, 10), 6);
+
+    Value_Pub_Set(&pub, 61);
+    Value_Pub_Reset_Conn(&conn); /* Resubscribed: due right away, whatever it had */
+    CHECK_EQ(Value_Pub_Due(&pub, &conn, 3, 10), 0);
+    CHECK_EQ(pub.updates, 4);
+    CHECK_EQ(pub.notified, 2);
+}
+
+/**
+ * @brief Publish a value that changes every tick, as Battery_Publish would with a flush timer
+ *
+ * @param hysteresis Change needed before notifying again
+ */
+static void Test_Burst(uint8_t hysteresis)
+{
+    Value_Pub pub;
+    Value_Pub_Conn conn;
+    uint32_t random = 7;
+    uint32_t flush_at = VALUE_PUB_IDLE;
+    uint32_t last_sent = 0;
+    char name[64];
+
+    Value_Pub_Init(&pub, 128, hysteresis);
+    Value_Pub_Reset_Conn(&conn);
+    for (uint32_t now = 1; now <= BURST_TICKS; now++)
+    {
+        int32_t step = (int32_t)(Next_Random(&random) % 7) - 3; /* Random walk, -3 to +3 per tick */
+        Value_Pub_Set(&pub, (uint8_t)(Value_Pub_Get(&pub) + step));
+
+        uint32_t wait = Value_Pub_Due(&pub, &conn, now, BURST_GAP);
+        if (wait == 0)
+        {
+            CHECK(!conn.sent || now - last_sent >= BURST_GAP); /* Never faster than the gap */
+            Value_Pub_Sent(&pub, &conn, now);
+            last_sent = now;
+            flush_at = VALUE_PUB_IDLE;
+        }
+        else if (wait != VALUE_PUB_IDLE)
+        {
+            flush_at = now + wait; /* The flush timer would fire then */
+        }
+    }
+    if (flush_at != VALUE_PUB_IDLE) /* The producer stops: the flush timer sends the latest value */
+    {
+        CHECK_EQ(Value_Pub_Due(&pub, &conn, flush_at, BURST_GAP), 0);
+        Value_Pub_Sent(&pub, &conn, flush_at);
+    }
+
+    CHECK_EQ(pub.updates, BURST_TICKS);
+    CHECK(pub.notified <= BURST_TICKS / BURST_GAP + 1);
+    CHECK(pub.notified > 0);
+    uint8_t delta = pub.value > conn.last ? pub.value - conn.last : conn.last - pub.value;
+    CHECK(delta < hysteresis); /* The client ends up close to the last value */
+
+    snprintf(name, sizeof(name), "burst, hysteresis %u, gap %u ticks", hysteresis, BURST_GAP);
+    printf("%-40s %8u values %8u notifications (%.1f%%)\n", name, (unsigned)pub.updates, (unsigned)pub.notified,
+           100.0 * pub.notified / pub.updates);
+}
+
+static void Test_Battery_Service(void)
+{
+    uint8_t level;
+    uint16_t len = sizeof(level);
+
+    Host_App_Start(NULL, NULL);
+    Stub_Notify_State.hook = Count_Battery;
+    Host_App_Connect(1, 0);
+    Host_App_Connect(2, 0);
+    Host_App_Subscribe(1, Battery_level_characteristic_attribute_handler, true);
+    Host_App_Subscribe(2, Battery_level_characteristic_attribute_handler, true);
+
+    Stub_Tick_Advance(pdMS_TO_TICKS(80000)); /* 80 levels, 99 down to 20 */
+    CHECK_EQ(Host_App_Read(Device_Battery_Level, 1, NULL, &level, &len), 0);
+    CHECK_EQ(level, 20);
+    CHECK_EQ(Seen.count[1], 40); /* 99, 97, ... 21: every other level */
+    CHECK_EQ(Seen.count[2], 40);
+    CHECK_EQ(Seen.last[1], 21);
+    printf("%-40s %8u values %8u notifications (%.1f%%)\n", "battery service, per subscriber", 80u, (unsigned)Seen.count[1],
+           100.0 * Seen.count[1] / 80);
+
+    Host_App_Subscribe(2, Battery_level_characteristic_attribute_handler, false);
+    Stub_Tick_Advance(pdMS_TO_TICKS(10000)); /* 19 down to 10 */
+    CHECK_EQ(Seen.count[1], 45);
+    CHECK_EQ(Seen.count[2], 40); /* Unsubscribed, nothing sent */
+
+    Host_App_Subscribe(2, Battery_level_characteristic_attribute_handler, true);
+    Stub_Tick_Advance(pdMS_TO_TICKS(1000)); /* 9: two below what both connections last received */
+    CHECK_EQ(Seen.count[1], 46);
+    CHECK_EQ(Seen.count[2], 41);
+
+    Host_App_Subscribe(2, Battery_level_characteristic_attribute_handler, false);
+    Host_App_Subscribe(2, Battery_level_characteristic_attribute_handler, true);
+    Stub_Tick_Advance(pdMS_TO_TICKS(1000)); /* 8: within the hysteresis, only the resubscribed connection gets it */
+    CHECK_EQ(Seen.count[1], 46);
+    CHECK_EQ(Seen.count[2], 42);
+    CHECK_EQ(Seen.last[2], 8);
+
+    Host_App_Disconnect(1);
+    Host_App_Disconnect(2);
+    Stub_Notify_State.hook = NULL;
+}
+
+int main(void)
+{
+    Stub_Log_Output(NULL);
+
+    Test_Policy();
+    Test_Burst(1);
+    Test_Burst(4);
+    Test_Battery_Service();
+
+    printf("test_value_pub: all checks passed\n");
+    return 0;
+}